@@ -0,0 +1,173 @@
+#include "AdaptiveRunRMQ.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+  /* Folds the values in [low, high) into a running minimum, with no index
+   * tracking and no branch, so the loop vectorizes.
+   */
+  inline int32_t minValue(const RMQEntry* elems, size_t low, size_t high, int32_t best) {
+    for (size_t i = low; i < high; i++) {
+      best = min(best, elems[i].value());
+    }
+    return best;
+  }
+
+  /* Returns the first index in [low, high) holding the given value, or high
+   * if there isn't one.
+   */
+  inline size_t find(const RMQEntry* elems, size_t low, size_t high, int32_t value) {
+    while (low < high && elems[low].value() != value) low++;
+    return low;
+  }
+}
+
+AdaptiveRunRMQ::AdaptiveRunRMQ(const RMQEntry* elems, size_t numElems) : array(elems) {
+  if (numElems > UINT32_MAX) throw length_error("Too many elements for 32-bit indices.");
+
+  /* Grow each run as far as it goes. The direction is settled by its first
+   * pair: a tie or a step up makes it nondecreasing, and a step down makes it
+   * strictly decreasing, so that a tie never ends up at the low end of a
+   * decreasing run where it would hide the leftmost minimum.
+   */
+  size_t start = 0;
+  while (start < numElems) {
+    size_t end = start + 1;
+    if (end < numElems && elems[end] < elems[start]) {
+      while (end < numElems && elems[end] < elems[end - 1]) end++;
+      runMinIndex.push_back(end - 1);
+    } else {
+      while (end < numElems && elems[end - 1] <= elems[end]) end++;
+      runMinIndex.push_back(start);
+    }
+    runStarts.push_back(start);
+    runMins.push_back(elems[runMinIndex.back()]);
+    start = end;
+  }
+
+  runStarts.shrink_to_fit();
+  runMinIndex.shrink_to_fit();
+  runMins.shrink_to_fit();
+
+  /* The minimum of each full or partial group of runs. */
+  size_t numRuns = runMins.size();
+  size_t numGroups = (numRuns + kRunsPerGroup - 1) / kRunsPerGroup;
+  groupMins.resize(numGroups);
+  for (size_t group = 0; group < numGroups; group++) {
+    size_t first = group * kRunsPerGroup;
+    size_t last  = min(numRuns, first + kRunsPerGroup);
+    groupMins[group] = RMQEntry(minValue(runMins.data(), first, last, runMins[first].value()));
+  }
+
+  /* The sparse table over the group minima. Ties go to the left. */
+  summary.resize(max<size_t>(1, bit_width(numGroups)));
+  summary[0].resize(numGroups);
+  for (size_t group = 0; group < numGroups; group++) {
+    summary[0][group] = group;
+  }
+  for (size_t k = 1; k < summary.size(); k++) {
+    const auto& prev = summary[k - 1];
+    auto& curr = summary[k];
+    size_t half = size_t(1) << (k - 1);
+    curr.resize(numGroups + 1 - 2 * half);
+    for (size_t i = 0; i < curr.size(); i++) {
+      uint32_t left = prev[i], right = prev[i + half];
+      curr[i] = groupMins[right] < groupMins[left]? right : left;
+    }
+  }
+}
+
+/* A binary search for the last run starting at or before the index. Each step
+ * halves the candidates with a select rather than a branch, since on inputs
+ * with many runs which way the search goes is a coin flip. The first run
+ * starts at zero, so there's always an answer.
+ */
+size_t AdaptiveRunRMQ::runOf(size_t index) const {
+  const uint32_t* starts = runStarts.data();
+  size_t base = 0;
+  for (size_t count = runStarts.size(); count > 1; count -= count / 2) {
+    size_t probe = base + count / 2;
+    base = starts[probe] <= index? probe : base;
+  }
+  return base;
+}
+
+/* A run's minimum sits at its start exactly when it's nondecreasing (a
+ * one-element run counts as either), which tells us which end of the subrange
+ * to take.
+ */
+size_t AdaptiveRunRMQ::minWithinRun(size_t run, size_t low, size_t high) const {
+  return runMinIndex[run] == runStarts[run]? low : high - 1;
+}
+
+/* The same shape as the block summary in FischerHeunRMQ: fold the runs before
+ * the first full group, the sparse table over the full groups, and the runs
+ * after them, then find the leftmost run holding that value.
+ */
+size_t AdaptiveRunRMQ::runsRMQ(size_t lowRun, size_t highRun) const {
+  size_t lowGroup  = (lowRun + kRunsPerGroup - 1) / kRunsPerGroup;
+  size_t highGroup = highRun / kRunsPerGroup;
+  const RMQEntry* mins = runMins.data();
+
+  int32_t best;
+  size_t group = 0;
+  if (lowGroup < highGroup) {
+    size_t row = bit_width((highGroup - lowGroup - 1) | 1) - 1;
+    uint32_t left  = summary[row][lowGroup];
+    uint32_t right = summary[row][highGroup - (size_t(1) << row)];
+    group = groupMins[right] < groupMins[left]? right : left;
+
+    best = minValue(mins, lowRun, lowGroup * kRunsPerGroup, groupMins[group].value());
+    best = minValue(mins, highGroup * kRunsPerGroup, highRun, best);
+  } else {
+    best = minValue(mins, lowRun, highRun, mins[lowRun].value());
+  }
+
+  /* Runs before the first full group, then the chosen group's runs, then the
+   * rest. If there are no full groups, the first search covers everything.
+   */
+  size_t firstEnd = lowGroup < highGroup? lowGroup * kRunsPerGroup : highRun;
+  size_t run = find(mins, lowRun, firstEnd, best);
+  if (run == firstEnd && lowGroup < highGroup) {
+    if (groupMins[group].value() == best) {
+      run = find(mins, group * kRunsPerGroup, highRun, best);
+    } else {
+      run = find(mins, highGroup * kRunsPerGroup, highRun, best);
+    }
+  }
+  return runMinIndex[run];
+}
+
+size_t AdaptiveRunRMQ::rmq(size_t low, size_t high) const {
+  size_t lowRun  = runOf(low);
+  size_t highRun = runOf(high - 1);
+  if (lowRun == highRun) return minWithinRun(lowRun, low, high);
+
+  /* Partial runs at either end, then any full runs in between. */
+  size_t best  = minWithinRun(lowRun, low, runStarts[lowRun + 1]);
+  size_t right = minWithinRun(highRun, runStarts[highRun], high);
+
+  if (lowRun + 1 < highRun) {
+    size_t middle = runsRMQ(lowRun + 1, highRun);
+    if (array[middle] < array[best]) best = middle;
+  }
+  if (array[right] < array[best]) best = right;
+  return best;
+}
+
+size_t AdaptiveRunRMQ::numRuns() const {
+  return runStarts.size();
+}
+
+size_t AdaptiveRunRMQ::memoryUsage() const {
+  size_t result = sizeof(*this)
+                + runStarts.capacity() * sizeof(uint32_t) + runMinIndex.capacity() * sizeof(uint32_t)
+                + runMins.capacity() * sizeof(RMQEntry) + groupMins.capacity() * sizeof(RMQEntry)
+                + summary.capacity() * sizeof(summary[0]);
+  for (const auto& level: summary) {
+    result += level.capacity() * sizeof(uint32_t);
+  }
+  return result;
+}
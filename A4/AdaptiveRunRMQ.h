@@ -0,0 +1,96 @@
+/******************************************************************************
+ * File: AdaptiveRunRMQ.h
+ *
+ * A range minimum query data structure that adapts to presorted inputs by
+ * working with monotone runs rather than individual elements.
+ *
+ * A linear scan splits the array into maximal runs, each of which is either
+ * nondecreasing or strictly decreasing. Within a run, the leftmost minimum of
+ * any subrange is one of its endpoints: the first element of a nondecreasing
+ * run, or the last element of a strictly decreasing one. So a query that falls
+ * inside a single run is answered by looking at which way that run goes.
+ *
+ * A query that spans several runs splits into a partial run at each end, each
+ * answered the same way, plus the runs fully in between. Those are answered
+ * from the run minima, grouped 16 runs at a time: a sparse table of 32-bit
+ * group numbers covers the full groups, and the partial groups at either end
+ * are scanned. Finding the runs containing the endpoints is a binary search
+ * over where the runs start.
+ *
+ * With r runs, this uses O(r) memory and answers queries in O(log r) time, so
+ * sorted and nearly sorted arrays need almost nothing, while random arrays
+ * (whose runs have about two elements each) need about six bytes per element.
+ *
+ * Arrays must have fewer than 2^32 elements.
+ */
+
+#ifndef AdaptiveRunRMQ_Included
+#define AdaptiveRunRMQ_Included
+
+#include "RMQEntry.h"
+#include <vector>
+#include <cstdint>
+
+class AdaptiveRunRMQ {
+public:
+  /* Constructs an RMQ structure from the specified array of elements. That
+   * array may be empty.
+   *
+   * As with the other RMQ types, the array must remain valid, and unchanged,
+   * for the lifetime of this data structure.
+   */
+  AdaptiveRunRMQ(const RMQEntry* elems, std::size_t numElems);
+
+  /* Performs an RMQ over the specified range. You can assume that low < high
+   * and that the bounds are in range and don't need to do any error-handling
+   * if this is not the case.
+   *
+   * The interval here is half-open. That is, the range in question here is
+   * [low, high).
+   *
+   * This function returns the *index* of the minimum value.
+   */
+  std::size_t rmq(std::size_t low, std::size_t high) const;
+
+  /* Returns the number of monotone runs the array was split into. */
+  std::size_t numRuns() const;
+
+  /* Returns the number of bytes of memory used by this RMQ structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const;
+
+private:
+  static constexpr std::size_t kRunsPerGroup = 16;
+
+  const RMQEntry* array;
+
+  std::vector<std::uint32_t> runStarts;   // Where each run begins, in order
+  std::vector<std::uint32_t> runMinIndex; // Where each run's minimum is
+  std::vector<RMQEntry>      runMins;     // Each run's minimum value
+  std::vector<RMQEntry>      groupMins;   // The minimum of each group of runs
+
+  /* summary[k][i] is the group holding the leftmost minimum of groups
+   * [i, i + 2^k).
+   */
+  std::vector<std::vector<std::uint32_t>> summary;
+
+  /* Returns the run containing the given index. */
+  std::size_t runOf(std::size_t index) const;
+
+  /* Returns the index of the leftmost minimum of [low, high), which must lie
+   * within the given run.
+   */
+  std::size_t minWithinRun(std::size_t run, std::size_t low, std::size_t high) const;
+
+  /* Returns the index of the leftmost minimum of runs [lowRun, highRun), which
+   * must be nonempty.
+   */
+  std::size_t runsRMQ(std::size_t lowRun, std::size_t highRun) const;
+
+  /* Copying is disabled. */
+  AdaptiveRunRMQ(const AdaptiveRunRMQ &) = delete;
+  void operator= (AdaptiveRunRMQ) = delete;
+};
+
+#endif
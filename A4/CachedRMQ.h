@@ -0,0 +1,198 @@
+/******************************************************************************
+ * File: CachedRMQ.h
+ *
+ * A wrapper that puts a fixed-size cache of recent answers in front of any of
+ * the RMQ types. When the same few ranges are queried over and over, answering
+ * from the cache skips the underlying structure entirely.
+ *
+ * The cache is an open-addressed table keyed by (low, high). Each key can live
+ * in any of a small window of slots starting at its hash, and when the window
+ * is full the key overwrites its first slot, so the table never grows.
+ *
+ * Every slot is guarded by its own sequence lock, which makes the cache
+ * lock-free: readers never wait, and they retry against the engine if a write
+ * to the slot they're reading races with them. A writer that finds the slot
+ * busy just skips caching that answer. Several threads can therefore query the
+ * same CachedRMQ at once, provided the underlying RMQ type allows concurrent
+ * queries as well.
+ *
+ * The hit and miss counts are split across cache-line-sized shards, and each
+ * thread counts into its own shard, so threads sharing a cache don't all fight
+ * over one counter. Reading a count sums the shards.
+ */
+
+#ifndef CachedRMQ_Included
+#define CachedRMQ_Included
+
+#include "RMQEntry.h"
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+
+template <typename RMQ> class CachedRMQ {
+public:
+  /* Default number of slots in the cache. */
+  static constexpr std::size_t kDefaultCapacity = 1 << 16;
+
+  /* Constructs an RMQ structure of the underlying type over the specified
+   * array, with a cache holding (at least) the given number of answers.
+   */
+  CachedRMQ(const RMQEntry* elems, std::size_t numElems, std::size_t capacity = kDefaultCapacity)
+    : engine(elems, numElems) {
+    numSlots = std::bit_ceil(std::max(capacity, kWindow));
+    slots    = std::make_unique<Slot[]>(numSlots);
+  }
+
+  /* Performs an RMQ over the range [low, high), answering from the cache if
+   * possible.
+   */
+  std::size_t rmq(std::size_t low, std::size_t high) const {
+    std::size_t home = hash(low, high);
+
+    for (std::size_t i = 0; i < kWindow; i++) {
+      std::size_t answer;
+      if (slots[(home + i) & (numSlots - 1)].read(low, high, answer)) {
+        counters[shardIndex()].hits.fetch_add(1, std::memory_order_relaxed);
+        return answer;
+      }
+    }
+
+    counters[shardIndex()].misses.fetch_add(1, std::memory_order_relaxed);
+    std::size_t answer = engine.rmq(low, high);
+
+    /* Take the first empty slot in the window, or else evict the first one. */
+    std::size_t target = home;
+    for (std::size_t i = 0; i < kWindow; i++) {
+      if (slots[(home + i) & (numSlots - 1)].empty()) {
+        target = home + i;
+        break;
+      }
+    }
+    slots[target & (numSlots - 1)].write(low, high, answer);
+
+    return answer;
+  }
+
+  /* Number of queries answered from the cache. */
+  std::size_t hits() const {
+    std::size_t result = 0;
+    for (const auto& shard: counters) {
+      result += shard.hits.load(std::memory_order_relaxed);
+    }
+    return result;
+  }
+
+  /* Number of queries passed through to the underlying structure. */
+  std::size_t misses() const {
+    std::size_t result = 0;
+    for (const auto& shard: counters) {
+      result += shard.misses.load(std::memory_order_relaxed);
+    }
+    return result;
+  }
+
+  /* Fraction of queries answered from the cache. */
+  double hitRate() const {
+    std::size_t numHits = hits();
+    std::size_t total   = numHits + misses();
+    return total == 0? 0.0 : double(numHits) / total;
+  }
+
+  /* Zeroes out the hit and miss counters. */
+  void resetCounters() {
+    for (auto& shard: counters) {
+      shard.hits.store(0, std::memory_order_relaxed);
+      shard.misses.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /* Returns the number of bytes of memory used by this structure, including
+   * the underlying RMQ structure.
+   */
+  std::size_t memoryUsage() const {
+    return sizeof(*this) + numSlots * sizeof(Slot) + engine.memoryUsage();
+  }
+
+private:
+  /* Number of consecutive slots a key may occupy. */
+  static constexpr std::size_t kWindow = 4;
+
+  /* Number of shards the hit and miss counts are split across. */
+  static constexpr std::size_t kCounterShards = 16;
+
+  /* One cached answer. An odd sequence number means a write is in progress.
+   * A high of zero marks an empty slot, since no real query has one.
+   */
+  struct alignas(32) Slot {
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<std::size_t>   low{0}, high{0}, answer{0};
+
+    bool empty() const {
+      return high.load(std::memory_order_relaxed) == 0;
+    }
+
+    /* Looks for the given key, reporting whether a consistent copy was found. */
+    bool read(std::size_t queryLow, std::size_t queryHigh, std::size_t& result) const {
+      std::uint64_t before = sequence.load(std::memory_order_acquire);
+      if (before & 1) return false;
+
+      std::size_t slotLow  = low.load(std::memory_order_relaxed);
+      std::size_t slotHigh = high.load(std::memory_order_relaxed);
+      result = answer.load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return sequence.load(std::memory_order_relaxed) == before
+          && slotLow == queryLow && slotHigh == queryHigh;
+    }
+
+    /* Stores an answer, unless another thread is already writing here. */
+    void write(std::size_t queryLow, std::size_t queryHigh, std::size_t result) {
+      std::uint64_t before = sequence.load(std::memory_order_relaxed);
+      if ((before & 1) || !sequence.compare_exchange_strong(before, before + 1, std::memory_order_acquire)) {
+        return;
+      }
+      std::atomic_thread_fence(std::memory_order_release);
+
+      low.store(queryLow, std::memory_order_relaxed);
+      high.store(queryHigh, std::memory_order_relaxed);
+      answer.store(result, std::memory_order_relaxed);
+
+      sequence.store(before + 2, std::memory_order_release);
+    }
+  };
+
+  RMQ engine;
+  std::unique_ptr<Slot[]> slots;
+  std::size_t numSlots;
+
+  /* One shard of the hit and miss counts, on a cache line of its own. */
+  struct alignas(64) CounterShard {
+    std::atomic<std::size_t> hits{0}, misses{0};
+  };
+  mutable CounterShard counters[kCounterShards];
+
+  /* The shard this thread counts into. Threads are handed shards in turn as
+   * they first show up, so they only share one once there are more threads
+   * than shards.
+   */
+  static std::size_t shardIndex() {
+    static std::atomic<std::size_t> nextShard{0};
+    thread_local std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kCounterShards;
+    return shard;
+  }
+
+  /* Home slot for a key. */
+  std::size_t hash(std::size_t low, std::size_t high) const {
+    std::uint64_t mixed = (std::uint64_t(low) * 0x9E3779B97F4A7C15ull) ^ high;
+    mixed *= 0xC2B2AE3D27D4EB4Full;
+    return (mixed >> 32) & (numSlots - 1);
+  }
+
+  /* Copying is disabled. */
+  CachedRMQ(const CachedRMQ &) = delete;
+  void operator= (CachedRMQ) = delete;
+};
+
+#endif
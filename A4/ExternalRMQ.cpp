@@ -0,0 +1,157 @@
+#include "ExternalRMQ.h"
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+using namespace std;
+
+static_assert(sizeof(RMQEntry) == sizeof(int32_t), "Files are read directly into RMQEntry arrays.");
+
+namespace {
+  /* Number of blocks read at a time while streaming the file. */
+  const size_t kStreamBlocks = 256;
+}
+
+ExternalRMQ::ExternalRMQ(const string& filename, size_t blockSize, size_t cacheBlocks)
+  : blockSize(blockSize), cache(max<size_t>(cacheBlocks, 1)) {
+  if (blockSize == 0 || blockSize > UINT32_MAX) throw invalid_argument("Block size must be between 1 and 2^32.");
+
+  fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) throw system_error(errno, generic_category(), "Can't open " + filename);
+
+  try {
+    struct stat info;
+    if (fstat(fd, &info) != 0) throw system_error(errno, generic_category(), "Can't stat " + filename);
+    if (info.st_size % sizeof(RMQEntry) != 0) throw invalid_argument(filename + " isn't an array of 32-bit integers.");
+    numElems = info.st_size / sizeof(RMQEntry);
+
+    /* Stream the file a chunk at a time, finding each block's minimum. */
+    size_t numBlocks = (numElems + blockSize - 1) / blockSize;
+    blockMins.resize(numBlocks);
+    blockOffsets.resize(numBlocks);
+
+    vector<RMQEntry> chunk(kStreamBlocks * blockSize);
+    for (size_t first = 0; first < numBlocks; first += kStreamBlocks) {
+      size_t start  = first * blockSize;
+      size_t length = min(chunk.size(), numElems - start);
+      readFully(chunk.data(), length * sizeof(RMQEntry), start * sizeof(RMQEntry));
+
+      for (size_t i = 0; i * blockSize < length; i++) {
+        const RMQEntry* block = chunk.data() + i * blockSize;
+        size_t count  = min(blockSize, length - i * blockSize);
+        size_t offset = min_element(block, block + count) - block;
+        blockMins[first + i]    = block[offset];
+        blockOffsets[first + i] = offset;
+      }
+    }
+
+    summary = make_unique<SparseTableRMQ>(blockMins.data(), blockMins.size());
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+}
+
+ExternalRMQ::~ExternalRMQ() {
+  close(fd);
+}
+
+size_t ExternalRMQ::rmq(size_t low, size_t high) const {
+  size_t lowBlock  = low / blockSize;
+  size_t highBlock = (high - 1) / blockSize;
+
+  /* Everything in one block: just scan it. */
+  if (lowBlock == highBlock) {
+    const RMQEntry* block = loadBlock(lowBlock);
+    size_t base = lowBlock * blockSize;
+    return base + (min_element(block + (low - base), block + (high - base)) - block);
+  }
+
+  /* Blocks that are covered completely are answered from the summary, so only
+   * the partly-covered blocks at either end need to be read.
+   */
+  size_t firstFull = (low % blockSize == 0)? lowBlock : lowBlock + 1;
+  size_t lastFull  = (high % blockSize == 0 || high == numElems)? highBlock + 1 : highBlock;
+
+  size_t best = SIZE_MAX;
+  RMQEntry bestValue;
+
+  if (firstFull != lowBlock) {
+    const RMQEntry* block = loadBlock(lowBlock);
+    size_t base = lowBlock * blockSize;
+    const RMQEntry* found = min_element(block + (low - base), block + blockSize);
+    best      = base + (found - block);
+    bestValue = *found;
+  }
+
+  if (firstFull < lastFull) {
+    size_t block = summary->rmq(firstFull, lastFull);
+    if (best == SIZE_MAX || blockMins[block] < bestValue) {
+      best      = block * blockSize + blockOffsets[block];
+      bestValue = blockMins[block];
+    }
+  }
+
+  if (lastFull == highBlock) {
+    const RMQEntry* block = loadBlock(highBlock);
+    size_t base = highBlock * blockSize;
+    const RMQEntry* found = min_element(block, block + (high - base));
+    if (best == SIZE_MAX || *found < bestValue) {
+      best = base + (found - block);
+    }
+  }
+
+  return best;
+}
+
+RMQEntry ExternalRMQ::at(size_t index) const {
+  return loadBlock(index / blockSize)[index % blockSize];
+}
+
+size_t ExternalRMQ::size() const {
+  return numElems;
+}
+
+size_t ExternalRMQ::blockReads() const {
+  return numReads;
+}
+
+size_t ExternalRMQ::memoryUsage() const {
+  size_t result = sizeof(*this) + blockMins.capacity() * sizeof(RMQEntry)
+                + blockOffsets.capacity() * sizeof(uint32_t)
+                + cache.capacity() * sizeof(CacheSlot) + summary->memoryUsage();
+  for (const auto& slot: cache) {
+    result += slot.values.capacity() * sizeof(RMQEntry);
+  }
+  return result;
+}
+
+const RMQEntry* ExternalRMQ::loadBlock(size_t block) const {
+  CacheSlot& slot = cache[block % cache.size()];
+  if (slot.block != block) {
+    size_t start = block * blockSize;
+    size_t count = min(blockSize, numElems - start);
+    slot.values.resize(blockSize);
+    readFully(slot.values.data(), count * sizeof(RMQEntry), start * sizeof(RMQEntry));
+    slot.block = block;
+    numReads++;
+  }
+  return slot.values.data();
+}
+
+void ExternalRMQ::readFully(void* buffer, size_t bytes, size_t offset) const {
+  char* out = static_cast<char*>(buffer);
+  while (bytes > 0) {
+    ssize_t count = pread(fd, out, bytes, offset);
+    if (count < 0 && errno == EINTR) continue;
+    if (count < 0)  throw system_error(errno, generic_category(), "Can't read input file");
+    if (count == 0) throw runtime_error("Input file ended unexpectedly.");
+
+    out    += count;
+    bytes  -= count;
+    offset += count;
+  }
+}
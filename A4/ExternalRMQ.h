@@ -0,0 +1,111 @@
+/******************************************************************************
+ * File: ExternalRMQ.h
+ *
+ * A range minimum query data structure for arrays that live in a file and are
+ * too big to hold in memory. The file is a flat array of native-endian 32-bit
+ * integers.
+ *
+ * The array is split into fixed-size blocks. Building streams the file once,
+ * keeping only the minimum of each block and where in the block it is, and
+ * builds a sparse table over those minima. That's everything that stays in
+ * memory: with the default block size, about 3 bytes for every thousand
+ * elements.
+ *
+ * A query is answered by the sparse table over the blocks that it covers
+ * completely, plus a scan of the at most two blocks that it only partly covers.
+ * Those blocks are read with pread through a small direct-mapped cache, so a
+ * query costs at most two block reads and often none at all.
+ *
+ * The cache is updated by queries, so even const queries must not be run from
+ * several threads at once.
+ */
+
+#ifndef ExternalRMQ_Included
+#define ExternalRMQ_Included
+
+#include "RMQEntry.h"
+#include "SparseTableRMQ.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+class ExternalRMQ {
+public:
+  /* Default number of elements in each block (16KB of file). */
+  static constexpr std::size_t kDefaultBlockSize = 4096;
+
+  /* Default number of blocks kept in the cache. */
+  static constexpr std::size_t kDefaultCacheBlocks = 64;
+
+  /* Constructs an RMQ structure over the array of 32-bit integers stored in the
+   * specified file, which must stay unchanged while this structure exists.
+   * Throws a system_error if the file can't be read.
+   */
+  explicit ExternalRMQ(const std::string& filename,
+                       std::size_t blockSize   = kDefaultBlockSize,
+                       std::size_t cacheBlocks = kDefaultCacheBlocks);
+
+  /* Closes the file. */
+  ~ExternalRMQ();
+
+  /* Performs an RMQ over the specified range. You can assume that low < high
+   * and that the bounds are in range and don't need to do any error-handling
+   * if this is not the case.
+   *
+   * The interval here is half-open. That is, the range in question here is
+   * [low, high).
+   *
+   * This function returns the *index* at which the minimum value occurs,
+   * rather than the minimum value itself.
+   */
+  std::size_t rmq(std::size_t low, std::size_t high) const;
+
+  /* Returns the element at the specified index, reading it from the file if
+   * its block isn't cached.
+   */
+  RMQEntry at(std::size_t index) const;
+
+  /* Returns the number of elements in the file. */
+  std::size_t size() const;
+
+  /* Returns the number of blocks read from the file since construction,
+   * not counting the initial streaming pass.
+   */
+  std::size_t blockReads() const;
+
+  /* Returns the number of bytes of memory used by this RMQ structure,
+   * including the block cache.
+   */
+  std::size_t memoryUsage() const;
+
+private:
+  /* One cached block of the file. */
+  struct CacheSlot {
+    std::size_t block = SIZE_MAX;  // Which block is here, if any
+    std::vector<RMQEntry> values;
+  };
+
+  int fd;
+  std::size_t numElems;
+  std::size_t blockSize;
+
+  std::vector<RMQEntry>          blockMins;    // Minimum value in each block
+  std::vector<std::uint32_t>     blockOffsets; // Where in its block that minimum is
+  std::unique_ptr<SparseTableRMQ> summary;     // RMQ over the block minima
+
+  mutable std::vector<CacheSlot> cache;
+  mutable std::size_t numReads = 0;
+
+  /* Returns the contents of the given block, reading it in if needed. */
+  const RMQEntry* loadBlock(std::size_t block) const;
+
+  /* Reads exactly the given number of bytes from the given file offset. */
+  void readFully(void* buffer, std::size_t bytes, std::size_t offset) const;
+
+  /* Copying is disabled. */
+  ExternalRMQ(const ExternalRMQ &) = delete;
+  void operator= (ExternalRMQ) = delete;
+};
+
+#endif
@@ -20,3 +20,7 @@ std::size_t FastestRMQ::rmq(std::size_t low, std::size_t high) const {
   (void) high;
   return 0;
 }
+
+std::size_t FastestRMQ::memoryUsage() const {
+  return sizeof(*this);
+}
@@ -41,6 +41,11 @@ public:
    */
   std::size_t rmq(std::size_t low, std::size_t high) const;
 
+  /* Returns the number of bytes of memory used by this RMQ structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const;
+
 private:
   /* TODO: Edit this type to implement it however you'd like. Then, delete this
    * comment.
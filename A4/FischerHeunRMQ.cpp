@@ -1,22 +1,275 @@
 #include "FischerHeunRMQ.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <memory>
 
-FischerHeunRMQ::FischerHeunRMQ(const RMQEntry* elems, std::size_t numElems) {
-  /* TODO: Delete this line, the lines after this one, and implement
-   * this function.
+namespace {
+  constexpr std::size_t kMaxBallot = 12;
+
+  /* kBallot[p][q] is the number of ways to finish a push/pop sequence with p
+   * pushes and q pops left to go, never popping an empty stack. That's zero
+   * when p > q, one when p = 0, and otherwise the count after pushing plus the
+   * count after popping. kBallot[b][b] is the Catalan number C_b.
+   */
+  constexpr auto kBallot = [] {
+    std::array<std::array<std::uint32_t, kMaxBallot + 1>, kMaxBallot + 1> result{};
+    for (std::size_t q = 0; q <= kMaxBallot; q++) {
+      result[0][q] = 1;
+      for (std::size_t p = 1; p <= q; p++) {
+        result[p][q] = result[p - 1][q] + result[p][q - 1];
+      }
+    }
+    return result;
+  }();
+
+  /* Folds the values in [low, high) into a running minimum. As in HybridRMQ,
+   * there's no index tracking and no branch, so the loop vectorizes.
    */
-  (void) elems;
-  (void) numElems;
+  inline std::int32_t minValue(const RMQEntry* elems, std::size_t low, std::size_t high,
+                               std::int32_t best) {
+    for (std::size_t i = low; i < high; i++) {
+      best = std::min(best, elems[i].value());
+    }
+    return best;
+  }
+
+  /* Returns the first index in [low, high) holding the given value, or high
+   * if there isn't one.
+   */
+  inline std::size_t find(const RMQEntry* elems, std::size_t low, std::size_t high,
+                          std::int32_t value) {
+    while (low < high && elems[low].value() != value) low++;
+    return low;
+  }
+}
+
+FischerHeunRMQ::FischerHeunRMQ(const RMQEntry* elems, std::size_t numElems, bool lazy)
+  : array(elems), numElems(numElems) {
+  static_assert(kMaxBlockSize <= kMaxBallot, "Ballot table too small for the largest block.");
+
+  std::size_t logN = std::bit_width(numElems);
+  blockSize = lazy? std::clamp<std::size_t>(3 * logN / 4, 1, kMaxBlockSize)
+                  : std::clamp<std::size_t>(logN / 2, 1, 8);
+  numSignatures = kBallot[blockSize][blockSize];
+  numBlocks = (numElems + blockSize - 1) / blockSize;
+
+  /* Tree numbers are filled in as blocks are first needed. They're stored
+   * plus one, so that zero means "not yet known."
+   */
+  signatures = HugeVector<std::atomic<std::uint32_t>>(numBlocks);
+
+  /* One pass over the array finds the block minima, and one much shorter pass
+   * over those finds the superblock minima.
+   */
+  blockMins.resize(numBlocks);
+  for (std::size_t block = 0; block < numBlocks; block++) {
+    std::size_t start = block * blockSize;
+    std::size_t end   = std::min(numElems, start + blockSize);
+    blockMins[block] = RMQEntry(minValue(elems, start, end, elems[start].value()));
+  }
+
+  std::size_t numSupers = (numBlocks + kBlocksPerSuper - 1) / kBlocksPerSuper;
+  superMins.resize(numSupers);
+  for (std::size_t super = 0; super < numSupers; super++) {
+    std::size_t start = super * kBlocksPerSuper;
+    std::size_t end   = std::min(numBlocks, start + kBlocksPerSuper);
+    superMins[super] = RMQEntry(minValue(blockMins.data(), start, end, blockMins[start].value()));
+  }
+
+  /* The sparse table over the superblock minima is trimmed to the runs of
+   * superblocks that fit. Ties go to the left.
+   */
+  summary.resize(std::max<std::size_t>(1, std::bit_width(numSupers)));
+  summary[0].resize(numSupers);
+  for (std::size_t super = 0; super < numSupers; super++) {
+    summary[0][super] = super;
+  }
+  for (std::size_t k = 1; k < summary.size(); k++) {
+    const auto& prev = summary[k - 1];
+    auto& curr = summary[k];
+    std::size_t half = std::size_t(1) << (k - 1);
+    curr.resize(numSupers + 1 - 2 * half);
+    for (std::size_t i = 0; i < curr.size(); i++) {
+      std::uint32_t left = prev[i], right = prev[i + half];
+      curr[i] = superMins[right] < superMins[left]? right : left;
+    }
+  }
+
+  if (!lazy) {
+    for (std::size_t block = 0; block < numBlocks; block++) {
+      tableFor(block);
+    }
+  }
 }
 
 FischerHeunRMQ::~FischerHeunRMQ() {
-  /* TODO: Delete this comment and implement this function. */
+  Slot* slots = tables.load(std::memory_order_relaxed);
+  if (slots == nullptr) return;
+
+  for (std::size_t s = 0; s < numSignatures; s++) {
+    delete[] slots[s].load(std::memory_order_relaxed);
+  }
+  hugePageDeallocate(slots, numSignatures * sizeof(Slot));
 }
 
-std::size_t FischerHeunRMQ::rmq(std::size_t low, std::size_t high) const {
-  /* TODO: Delete this line, the lines after this one, and implement
-   * this function.
+/* The number is the rank of the block's push/pop sequence on the Cartesian
+ * tree stack among all valid sequences, where pushes come before pops: each
+ * pop skips over every sequence that would have pushed there instead. A short
+ * last block is padded out with pushes, as if it ended in elements bigger than
+ * everything else.
+ */
+std::uint32_t FischerHeunRMQ::signatureOf(std::size_t block) const {
+  std::uint32_t known = signatures[block].load(std::memory_order_relaxed);
+  if (known != 0) return known - 1;
+
+  std::size_t start = block * blockSize;
+  std::size_t count = std::min(blockSize, numElems - start);
+  RMQEntry stack[kMaxBlockSize];
+  std::size_t height = 0;
+  std::size_t pushes = blockSize, pops = blockSize;
+  std::uint32_t signature = 0;
+
+  for (std::size_t i = 0; i < count; i++) {
+    while (height > 0 && stack[height - 1] > array[start + i]) {
+      height--;
+      signature += kBallot[pushes - 1][pops];
+      pops--;
+    }
+    stack[height++] = array[start + i];
+    pushes--;
+  }
+
+  /* Every thread computes the same number, so a plain store is enough. */
+  signatures[block].store(signature + 1, std::memory_order_relaxed);
+  return signature;
+}
+
+const std::uint8_t* FischerHeunRMQ::tableFor(std::size_t block) const {
+  /* Make the slot array the first time through, the same way tables are
+   * published below.
    */
-  (void) low;
-  (void) high;
-  return 0;
+  Slot* slots = tables.load(std::memory_order_acquire);
+  if (slots == nullptr) {
+    Slot* made = static_cast<Slot*>(hugePageAllocate(numSignatures * sizeof(Slot)));
+    std::uninitialized_value_construct_n(made, numSignatures);
+    if (tables.compare_exchange_strong(slots, made, std::memory_order_acq_rel)) {
+      slots = made;
+    } else {
+      hugePageDeallocate(made, numSignatures * sizeof(Slot));
+    }
+  }
+
+  auto& slot = slots[signatureOf(block)];
+  const std::uint8_t* table = slot.load(std::memory_order_acquire);
+  if (table != nullptr) return table;
+
+  /* Build the table from this block. Padding past the end of a short block
+   * counts as bigger than everything, matching how its number was computed.
+   */
+  std::size_t start = block * blockSize;
+  std::size_t count = std::min(blockSize, numElems - start);
+  auto less = [&](std::size_t i, std::size_t j) {
+    return i < count && (j >= count || array[start + i] < array[start + j]);
+  };
+
+  std::uint8_t* built = new std::uint8_t[blockSize * blockSize];
+  for (std::size_t i = 0; i < blockSize; i++) {
+    std::size_t smallest = i;
+    for (std::size_t j = i; j < blockSize; j++) {
+      if (less(j, smallest)) smallest = j;
+      built[i * blockSize + j] = smallest;
+    }
+  }
+
+  /* Publish it, unless someone else beat us to it. */
+  const std::uint8_t* expected = nullptr;
+  if (slot.compare_exchange_strong(expected, built, std::memory_order_acq_rel)) {
+    tablesBuilt.fetch_add(1, std::memory_order_relaxed);
+    return built;
+  }
+  delete[] built;
+  return expected;
+}
+
+/* The full superblocks in the middle come from the sparse table, and the
+ * blocks on either side of them from folding over at most 2 * kBlocksPerSuper
+ * block minima. Once we know the smallest value, we walk down to the leftmost
+ * block holding it and then to the leftmost element of that block.
+ */
+std::size_t FischerHeunRMQ::blocksRMQ(std::size_t lowBlock, std::size_t highBlock) const {
+  std::size_t lowSuper  = (lowBlock + kBlocksPerSuper - 1) / kBlocksPerSuper;
+  std::size_t highSuper = highBlock / kBlocksPerSuper;
+  const RMQEntry* mins = blockMins.data();
+
+  std::int32_t best;
+  std::size_t super = 0;
+  if (lowSuper < highSuper) {
+    std::size_t row = std::bit_width((highSuper - lowSuper - 1) | 1) - 1;
+    std::uint32_t left  = summary[row][lowSuper];
+    std::uint32_t right = summary[row][highSuper - (std::size_t(1) << row)];
+    super = superMins[right] < superMins[left]? right : left;
+
+    best = minValue(mins, lowBlock, lowSuper * kBlocksPerSuper, superMins[super].value());
+    best = minValue(mins, highSuper * kBlocksPerSuper, highBlock, best);
+  } else {
+    best = minValue(mins, lowBlock, highBlock, mins[lowBlock].value());
+  }
+
+  /* Blocks before the first full superblock, then that superblock's blocks,
+   * then the rest. If there are no full superblocks, the first search covers
+   * everything.
+   */
+  std::size_t firstEnd = lowSuper < highSuper? lowSuper * kBlocksPerSuper : highBlock;
+  std::size_t block = find(mins, lowBlock, firstEnd, best);
+  if (block == firstEnd && lowSuper < highSuper) {
+    if (superMins[super].value() == best) {
+      block = find(mins, super * kBlocksPerSuper, highBlock, best);
+    } else {
+      block = find(mins, highSuper * kBlocksPerSuper, highBlock, best);
+    }
+  }
+
+  std::size_t start = block * blockSize;
+  return find(array, start, std::min(numElems, start + blockSize), best);
+}
+
+std::size_t FischerHeunRMQ::rmq(std::size_t low, std::size_t high) const {
+  std::size_t lowBlock  = low / blockSize;
+  std::size_t highBlock = (high - 1) / blockSize;
+  std::size_t lowStart  = lowBlock  * blockSize;
+  std::size_t highStart = highBlock * blockSize;
+
+  if (lowBlock == highBlock) {
+    return lowStart + tableFor(lowBlock)[(low - lowStart) * blockSize + (high - 1 - lowStart)];
+  }
+
+  std::size_t best  = lowStart + tableFor(lowBlock)[(low - lowStart) * blockSize + blockSize - 1];
+  std::size_t right = highStart + tableFor(highBlock)[high - 1 - highStart];
+
+  if (lowBlock + 1 < highBlock) {
+    std::size_t middle = blocksRMQ(lowBlock + 1, highBlock);
+    if (array[middle] < array[best]) best = middle;
+  }
+  if (array[right] < array[best]) best = right;
+
+  return best;
+}
+
+std::size_t FischerHeunRMQ::memoryUsage() const {
+  std::size_t result = sizeof(*this) + numBlocks * sizeof(signatures[0])
+                     + blockMins.capacity() * sizeof(RMQEntry) + superMins.capacity() * sizeof(RMQEntry)
+                     + summary.capacity() * sizeof(summary[0])
+                     + numTables() * blockSize * blockSize;
+  for (const auto& level: summary) {
+    result += level.capacity() * sizeof(std::uint32_t);
+  }
+  if (tables.load(std::memory_order_relaxed) != nullptr) {
+    result += numSignatures * sizeof(Slot);
+  }
+  return result;
+}
+
+std::size_t FischerHeunRMQ::numTables() const {
+  return tablesBuilt.load(std::memory_order_relaxed);
 }
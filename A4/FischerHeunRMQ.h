@@ -3,13 +3,38 @@
  *
  * A range minimum query data structure implemented using the Fischer-Heun
  * structure described in class.
+ *
+ * The array is split into blocks of about (log n) / 2 elements, capped at 8.
+ * Each block is labeled with its Cartesian tree number, and blocks with the
+ * same number share one table answering every RMQ inside the block.
+ *
+ * Cartesian tree numbers are ranks among the Catalan(b) possible trees, found
+ * from the stack pushes and pops with a table of ballot numbers, so there are
+ * only as many table slots as there are trees.
+ *
+ * The blocks in between the ends of a query are handled by a two-level
+ * summary. Blocks are grouped into superblocks of 16, and a sparse table over
+ * the superblock minima covers the full superblocks, while the block minima
+ * on either side of them are folded directly. The sparse table is then over
+ * only n / 16b values, so it's cheap to build.
+ *
+ * In lazy mode, blocks are about 1.5 times as long (capped at 12), and the
+ * constructor only finds the block and superblock minima, with branch-free
+ * folds, and builds the small sparse table. Cartesian tree numbers, the table
+ * slots, and the in-block tables are all worked out the first time a query
+ * needs them. Tables are published with a compare-and-swap, so several
+ * threads can safely query at once: if two of them race to build the same
+ * table, one copy wins and the other is thrown away.
  */
 
 #ifndef FischerHeunRMQ_Included
 #define FischerHeunRMQ_Included
 
 #include "RMQEntry.h"
+#include "HugePageAllocator.h"
 #include <vector>
+#include <atomic>
+#include <cstdint>
 
 class FischerHeunRMQ {
 public:
@@ -21,8 +46,11 @@ public:
    * throughout the lifetime of this data structure. You should not modify the
    * contents of this array, as it might be shared across multiple RMQ
    * structures, nor should you delete it.
+   *
+   * If lazy is true, the in-block tables are built on demand by queries rather
+   * than up front.
    */
-  FischerHeunRMQ(const RMQEntry* elems, std::size_t numElems);
+  FischerHeunRMQ(const RMQEntry* elems, std::size_t numElems, bool lazy = false);
   
   /* Frees all memory associated with this RMQ structure. */
   ~FischerHeunRMQ();
@@ -40,15 +68,82 @@ public:
    */
   std::size_t rmq(std::size_t low, std::size_t high) const;
 
+  /* Returns the number of bytes of memory used by this RMQ structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const;
+
+  /* Returns how many distinct in-block tables have been built so far. */
+  std::size_t numTables() const;
+
 private:
-  /* TODO: Edit this type to implement it however you'd like. Then, delete this
-   * comment.
+  /* Largest block size. There are Catalan(12) = 208,012 Cartesian trees on
+   * 12 nodes, which keeps the slot array small.
    */
-  
+  static constexpr std::size_t kMaxBlockSize = 12;
+
+  using Slot = std::atomic<const std::uint8_t*>;
+
+  /* The per-block arrays, the summary, and the slot array are the big tables
+   * here, so they can go on huge pages.
+   */
+  template <typename T> using HugeVector = std::vector<T, HugePageAllocator<T>>;
+
+  const RMQEntry* array;
+  std::size_t numElems;
+  std::size_t blockSize;
+  std::size_t numBlocks;
+
+  /* Number of blocks in each superblock of the summary. */
+  static constexpr std::size_t kBlocksPerSuper = 16;
+
+  /* Cartesian tree number of each block plus one, or zero if it hasn't been
+   * worked out yet.
+   */
+  mutable HugeVector<std::atomic<std::uint32_t>> signatures;
+  HugeVector<RMQEntry> blockMins;  // Minimum value in each block
+  HugeVector<RMQEntry> superMins;  // Minimum value in each superblock
+
+  /* Sparse table over the superblock minima. Level k holds, for each run of
+   * 2^k superblocks that fits, the superblock with the smallest minimum.
+   */
+  std::vector<HugeVector<std::uint32_t>> summary;
+
+  /* The slot for tree number s points to the table answering RMQs inside any
+   * block with that number. Entry i * blockSize + j of a table is the offset
+   * of the minimum of [i, j], inclusive. The slot array itself is made the
+   * first time any table is needed.
+   */
+  mutable std::atomic<Slot*> tables{nullptr};
+  std::size_t numSignatures;
+  mutable std::atomic<std::size_t> tablesBuilt{0};
+
+  /* Returns the Cartesian tree number of the given block, working it out if
+   * it isn't known yet.
+   */
+  std::uint32_t signatureOf(std::size_t block) const;
+
+  /* Returns the index of the leftmost minimum of the elements in blocks
+   * [lowBlock, highBlock).
+   */
+  std::size_t blocksRMQ(std::size_t lowBlock, std::size_t highBlock) const;
+
+  /* Returns the table for the given block, building it if needed. */
+  const std::uint8_t* tableFor(std::size_t block) const;
+
   /* Copying is disabled. */
   FischerHeunRMQ(const FischerHeunRMQ &) = delete;
   void operator= (FischerHeunRMQ) = delete;
 };
 
+/* Fischer-Heun structure that always builds its in-block tables on demand. */
+class LazyFischerHeunRMQ: public FischerHeunRMQ {
+public:
+  LazyFischerHeunRMQ(const RMQEntry* elems, std::size_t numElems)
+    : FischerHeunRMQ(elems, numElems, true) {
+    // Handled in initializer list
+  }
+};
+
 
 #endif
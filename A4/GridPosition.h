@@ -0,0 +1,18 @@
+/******************************************************************************
+ * File: GridPosition.h
+ *
+ * Header defining the GridPosition type, which the two-dimensional RMQ types
+ * use to report where in a grid the minimum of a rectangle is.
+ */
+
+#ifndef GridPosition_Included
+#define GridPosition_Included
+
+#include <cstddef>
+
+/* A cell in a grid stored in row-major order. */
+struct GridPosition {
+  std::size_t row, col;
+};
+
+#endif
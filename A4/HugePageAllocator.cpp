@@ -0,0 +1,97 @@
+#include "HugePageAllocator.h"
+#include <new>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+using namespace std;
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace {
+  const size_t kHugePageSize = 2 * 1024 * 1024;
+
+  bool useHugePages = false;
+
+  /* Rounds a size up to a whole number of huge pages. */
+  size_t roundToHugePages(size_t bytes) {
+    return (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  }
+}
+
+void setHugePagesEnabled(bool enabled) {
+  useHugePages = enabled;
+}
+
+bool hugePagesEnabled() {
+  return useHugePages;
+}
+
+#ifdef __linux__
+
+namespace {
+  /* Every mapping hugePageAllocate has made and not yet released. */
+  mutex mappingsLock;
+  unordered_set<void*> mappings;
+
+  void* remember(void* mapping) {
+    lock_guard<mutex> guard(mappingsLock);
+    mappings.insert(mapping);
+    return mapping;
+  }
+
+  /* Forgets a mapping, reporting whether it was one. */
+  bool forget(void* memory) {
+    lock_guard<mutex> guard(mappingsLock);
+    return mappings.erase(memory) != 0;
+  }
+}
+
+void* hugePageAllocate(size_t bytes) {
+  if (!useHugePages || bytes < kHugePageSize) return ::operator new(bytes);
+  size_t length = roundToHugePages(bytes);
+
+  /* Explicitly reserved huge pages are the best option, if there are any. */
+  void* result = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (result != MAP_FAILED) return remember(result);
+
+  /* Otherwise, map an extra huge page's worth of memory so that we can trim
+   * the mapping down to a 2MB-aligned region, which is what transparent huge
+   * pages need.
+   */
+  void* raw = mmap(nullptr, length + kHugePageSize, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) throw bad_alloc();
+
+  uintptr_t start   = reinterpret_cast<uintptr_t>(raw);
+  uintptr_t aligned = (start + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  if (aligned != start) munmap(raw, aligned - start);
+  munmap(reinterpret_cast<void*>(aligned + length), start + kHugePageSize - aligned);
+
+  result = reinterpret_cast<void*>(aligned);
+  madvise(result, length, MADV_HUGEPAGE);
+  return remember(result);
+}
+
+void hugePageDeallocate(void* memory, size_t bytes) noexcept {
+  if (bytes >= kHugePageSize && forget(memory)) {
+    munmap(memory, roundToHugePages(bytes));
+  } else {
+    ::operator delete(memory);
+  }
+}
+
+#else
+
+/* Without mmap, there's nothing special we can do. */
+void* hugePageAllocate(size_t bytes) {
+  return ::operator new(bytes);
+}
+
+void hugePageDeallocate(void* memory, size_t) noexcept {
+  ::operator delete(memory);
+}
+
+#endif
@@ -0,0 +1,72 @@
+/******************************************************************************
+ * File: HugePageAllocator.h
+ *
+ * An allocator for large tables that can optionally back them with 2MB huge
+ * pages rather than ordinary 4KB pages.
+ *
+ * Random queries into a big table (a sparse table over half a million elements
+ * spans well over a hundred megabytes) touch a different page almost every
+ * time, so the cost of a query is often dominated by TLB misses. With 2MB
+ * pages, each TLB entry covers 512 times as much memory, and those misses
+ * mostly go away.
+ *
+ * When huge pages are enabled, large allocations (at least one huge page's
+ * worth) first ask for explicitly reserved huge pages (MAP_HUGETLB), and if
+ * none are available fall back to an ordinary mapping aligned to 2MB with
+ * advice to the kernel to use transparent huge pages for it (MADV_HUGEPAGE).
+ * Everything else goes through operator new, exactly as it would with the
+ * default allocator, so with huge pages disabled the kernel's usual
+ * transparent huge page policy applies untouched. The mappings made while
+ * huge pages were on are remembered, so each allocation is released the way
+ * it was made even if the setting changes in between.
+ *
+ * Huge pages are disabled by default.
+ */
+
+#ifndef HugePageAllocator_Included
+#define HugePageAllocator_Included
+
+#include <cstddef>
+
+/* Switches huge pages on or off for allocations made from here on. */
+void setHugePagesEnabled(bool enabled);
+
+/* Whether huge pages are currently switched on. */
+bool hugePagesEnabled();
+
+/* Allocates and frees raw memory using the policy described above. The size
+ * passed in when freeing must match the size passed in when allocating.
+ */
+void* hugePageAllocate(std::size_t bytes);
+void  hugePageDeallocate(void* memory, std::size_t bytes) noexcept;
+
+/* Standard allocator interface on top of hugePageAllocate, so this can be
+ * dropped into a std::vector.
+ */
+template <typename T> class HugePageAllocator {
+public:
+  using value_type = T;
+
+  HugePageAllocator() noexcept = default;
+  template <typename U> HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t count) {
+    return static_cast<T*>(hugePageAllocate(count * sizeof(T)));
+  }
+
+  void deallocate(T* memory, std::size_t count) noexcept {
+    hugePageDeallocate(memory, count * sizeof(T));
+  }
+};
+
+/* All of these allocators are interchangeable. */
+template <typename T, typename U>
+bool operator== (const HugePageAllocator<T>&, const HugePageAllocator<U>&) {
+  return true;
+}
+template <typename T, typename U>
+bool operator!= (const HugePageAllocator<T>&, const HugePageAllocator<U>&) {
+  return false;
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include "HybridMinMaxRMQ.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+using namespace std;
+
+HybridMinMaxRMQ::HybridMinMaxRMQ(const RMQEntry* elems, size_t numElems) : array(elems) {
+  if (numElems > UINT32_MAX) throw length_error("Too many elements for 32-bit indices.");
+
+  blockSize = max<size_t>(1, round(sqrt(numElems)));
+  summaries.reserve((numElems + blockSize - 1) / blockSize);
+
+  /* Ties keep the earlier index on both sides, so both answers are leftmost. */
+  for (size_t start = 0; start < numElems; start += blockSize) {
+    Summary summary = { elems[start].value(), elems[start].value(), uint32_t(start), uint32_t(start) };
+    for (size_t i = start + 1; i < min(numElems, start + blockSize); i++) {
+      if (elems[i].value() < summary.minValue) summary = { elems[i].value(), summary.maxValue, uint32_t(i), summary.maxIndex };
+      if (elems[i].value() > summary.maxValue) summary = { summary.minValue, elems[i].value(), summary.minIndex, uint32_t(i) };
+    }
+    summaries.push_back(summary);
+  }
+}
+
+namespace {
+  /* Folds the values in [low, high) into a running minimum and maximum. As in
+   * HybridRMQ, there's no index tracking and no data-dependent branch, so the
+   * compiler can vectorize the loop, and here each load feeds both folds.
+   */
+  inline void foldValues(const RMQEntry* elems, size_t low, size_t high,
+                         int32_t& smallest, int32_t& largest) {
+    for (size_t i = low; i < high; i++) {
+      smallest = min(smallest, elems[i].value());
+      largest  = max(largest,  elems[i].value());
+    }
+  }
+}
+
+/* The same three pieces as HybridRMQ::rmq: the partial first block, the
+ * summaries of the full blocks in between, and the partial last block, with
+ * the loop bounds making unneeded pieces empty. Both extremes are folded in
+ * one pass, then each is found by scanning forward for its first occurrence.
+ */
+MinMaxPosition HybridMinMaxRMQ::rmq(size_t low, size_t high) const {
+  size_t lowBlock  = low / blockSize;
+  size_t highBlock = (high - 1) / blockSize;
+
+  size_t firstEnd  = min(high, (lowBlock + 1) * blockSize);
+  size_t lastStart = max(firstEnd, highBlock * blockSize);
+  size_t midEnd    = max(lowBlock + 1, highBlock);
+
+  int32_t smallest = array[low].value(), largest = array[low].value();
+  foldValues(array, low, firstEnd, smallest, largest);
+  for (size_t block = lowBlock + 1; block < midEnd; block++) {
+    smallest = min(smallest, summaries[block].minValue);
+    largest  = max(largest,  summaries[block].maxValue);
+  }
+  foldValues(array, lastStart, high, smallest, largest);
+
+  /* Find the leftmost place each extreme shows up. */
+  auto find = [&](int32_t value, int32_t Summary::* blockValue, uint32_t Summary::* blockIndex) {
+    for (size_t i = low; i < firstEnd; i++) {
+      if (array[i].value() == value) return i;
+    }
+    for (size_t block = lowBlock + 1; block < midEnd; block++) {
+      if (summaries[block].*blockValue == value) return size_t(summaries[block].*blockIndex);
+    }
+    for (size_t i = lastStart; i < high; i++) {
+      if (array[i].value() == value) return i;
+    }
+    return low; // Unreachable; the value came from one of the pieces above.
+  };
+
+  return { find(smallest, &Summary::minValue, &Summary::minIndex),
+           find(largest,  &Summary::maxValue, &Summary::maxIndex) };
+}
+
+size_t HybridMinMaxRMQ::memoryUsage() const {
+  return sizeof(*this) + summaries.capacity() * sizeof(Summary);
+}
@@ -0,0 +1,62 @@
+/******************************************************************************
+ * File: HybridMinMaxRMQ.h
+ *
+ * A version of HybridRMQ that answers range minimum and range maximum queries
+ * over the same range with a single pass.
+ *
+ * The array is split into blocks of about sqrt(n) elements, and each block's
+ * summary holds the value and index of both its minimum and its maximum, side
+ * by side in one 16-byte record. A query folds the minimum and the maximum of
+ * the partial blocks at either end and of the block summaries in between in
+ * the same loops, so it reads each element and each summary once rather than
+ * once per extreme.
+ *
+ * Arrays must have fewer than 2^32 elements.
+ */
+
+#ifndef HybridMinMaxRMQ_Included
+#define HybridMinMaxRMQ_Included
+
+#include "RMQEntry.h"
+#include "MinMaxPosition.h"
+#include <vector>
+#include <cstdint>
+
+class HybridMinMaxRMQ {
+public:
+  /* Constructs a min/max structure from the specified array of elements. That
+   * array may be empty.
+   *
+   * As with the other RMQ types, the array must remain valid, and unchanged,
+   * for the lifetime of this data structure.
+   */
+  HybridMinMaxRMQ(const RMQEntry* elems, std::size_t numElems);
+
+  /* Returns the indices of the leftmost minimum and the leftmost maximum of
+   * [low, high). You can assume that low < high and that the bounds are in
+   * range.
+   */
+  MinMaxPosition rmq(std::size_t low, std::size_t high) const;
+
+  /* Returns the number of bytes of memory used by this structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const;
+
+private:
+  /* The extremes of one block. */
+  struct Summary {
+    std::int32_t  minValue, maxValue;
+    std::uint32_t minIndex, maxIndex;
+  };
+
+  std::vector<Summary> summaries;
+  const RMQEntry* array;
+  std::size_t blockSize;
+
+  /* Copying is disabled. */
+  HybridMinMaxRMQ(const HybridMinMaxRMQ &) = delete;
+  void operator= (HybridMinMaxRMQ) = delete;
+};
+
+#endif
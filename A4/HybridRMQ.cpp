@@ -1,8 +1,16 @@
 #include "HybridRMQ.h"
 
 HybridRMQ::HybridRMQ(const RMQEntry* elems, std::size_t numElems) {
-  
-  blockSize = round(sqrt(numElems));
+  rebuild(elems, numElems);
+}
+
+/* The summaries are cleared rather than freed, so a rebuild over an array no
+ * larger than the last one refills the same storage.
+ */
+void HybridRMQ::rebuild(const RMQEntry* elems, std::size_t numElems) {
+  blockSize = std::max<std::size_t>(1, round(sqrt(numElems)));
+  summary.clear();
+  summaryValues.clear();
   summary.reserve((numElems/blockSize) + 1);
   array = elems;
    std::size_t count = 0;
@@ -27,77 +35,74 @@ HybridRMQ::HybridRMQ(const RMQEntry* elems, std::size_t numElems) {
       summary.emplace_back(smallest);
     }
   }
+
+  /* Keep the summary values next to each other so queries can scan them
+   * without chasing indices back into the array.
+   */
+  summaryValues.reserve(summary.size());
+  for (std::size_t index: summary)
+  {
+    summaryValues.emplace_back(elems[index].value());
+  }
 } 
 
 HybridRMQ::~HybridRMQ() {
  
 }
 
+namespace {
+  /* Folds the values in [low, high) into a running minimum. There's no index
+   * tracking and no data-dependent branch here, so the compiler is free to
+   * vectorize the loop.
+   */
+  inline std::int32_t minValue(const RMQEntry* elems, std::size_t low, std::size_t high,
+                               std::int32_t best) {
+    for (std::size_t i = low; i < high; i++) {
+      best = std::min(best, elems[i].value());
+    }
+    return best;
+  }
+}
+
+/* Queries avoid data-dependent branches. Rather than splitting into cases
+ * based on how far apart the endpoints' blocks are, we always look at the
+ * partial first block, then the summaries of any full blocks in between, then
+ * the partial last block; the loop bounds make the unneeded pieces empty.
+ *
+ * We do this as a min reduction over values followed by a search for where
+ * that value first appears. The reduction has no branches at all, and the
+ * search only has loop exits, each of which mispredicts at most once, so we
+ * avoid the steady stream of mispredictions that "if (array[i] < ...)" updates
+ * cause on random inputs.
+ */
 std::size_t HybridRMQ::rmq(std::size_t low, std::size_t high) const {
-  std::size_t lowBlock = ((low - (low%blockSize))/blockSize);
-  std::size_t highBlock = (((high - 1) - ((high - 1)%blockSize))/blockSize);
-  std::size_t smallest = low;
+  std::size_t lowBlock  = low / blockSize;
+  std::size_t highBlock = (high - 1) / blockSize;
 
-  //std::cout << arrayCpy[0] << std::endl;
-  //std::cout << lowBlock << " " << highBlock << "//";
+  std::size_t firstEnd  = std::min(high, (lowBlock + 1) * blockSize);
+  std::size_t lastStart = std::max(firstEnd, highBlock * blockSize);
+  std::size_t midEnd    = std::max(lowBlock + 1, highBlock);
 
-  //std::cout << blockSize << " " << low << " " << high;
+  std::int32_t best = minValue(array, low, firstEnd, array[low].value());
+  for (std::size_t block = lowBlock + 1; block < midEnd; block++) {
+    best = std::min(best, summaryValues[block]);
+  }
+  best = minValue(array, lastStart, high, best);
 
-  if(lowBlock == highBlock)
-  {
-    for(std::size_t i = low; i < high; i = i+1)
-    {
-      if(array[i] < array[smallest])
-      {
-        smallest = i;
-      }
-    }
-    //std::cout << " a ";
+  /* Find the leftmost place the minimum shows up. */
+  for (std::size_t i = low; i < firstEnd; i++) {
+    if (array[i].value() == best) return i;
   }
-  else if(highBlock == lowBlock +1)
-  {
-  for(std::size_t i = low; i < high; i = i+1)
-    {
-      if(array[i] < array[smallest])
-      {
-        smallest = i;
-      }
-    }
-   // std::cout << " b ";
+  for (std::size_t block = lowBlock + 1; block < midEnd; block++) {
+    if (summaryValues[block] == best) return summary[block];
   }
-  else{
-    //std::cout << "\n";
-    for(std::size_t i = low; i < (((low - (low%blockSize)))+blockSize); i = i+1)
-    {
-      //std::cout << " " << array[i].value();
-      if(array[i] < array[smallest])
-      {
-        smallest = i;
-      }
-    }
-  
-    for(std::size_t i = ((((low - (low%blockSize)+blockSize)/blockSize))); i < (((high) - ((high)%blockSize))/blockSize); i = i + 1)
-    {
-      //std::cout << " " << array[summary[i]].value();
-      if(array[summary[i]] < array[smallest])
-      {
-        smallest = summary[i];
-        
-      }
-    }
-
-    
-   // std::cout << " " << ((((low - (low%blockSize)+blockSize)/blockSize))) << " " << (((high) - ((high)%blockSize))/blockSize);
-    for(std::size_t i = (high-1) - ((high-1)%blockSize); i < high; i = i+1)
-    {
-      //std::cout << " " << array[i].value();
-      if(array[i] < array[smallest])
-      {
-        smallest = i;
-      }
-    }
-   //std::cout << " c " << (((low - (low%blockSize)))) << " ";
+  for (std::size_t i = lastStart; i < high; i++) {
+    if (array[i].value() == best) return i;
   }
-  //std::cout << smallest << "\n";
-  return smallest;
+  return low; // Unreachable; the minimum came from one of the pieces above.
+}
+
+std::size_t HybridRMQ::memoryUsage() const {
+  return sizeof(*this) + summary.capacity() * sizeof(summary[0])
+       + summaryValues.capacity() * sizeof(summaryValues[0]);
 }
@@ -26,6 +26,12 @@ public:
    * structures, nor should you delete it.
    */
   HybridRMQ(const RMQEntry* elems, std::size_t numElems);
+
+  /* Rebuilds this structure over a new array, as if it had just been
+   * constructed from it. The existing summaries are reused, so this allocates
+   * no memory unless the new array needs more blocks than any seen before.
+   */
+  void rebuild(const RMQEntry* elems, std::size_t numElems);
   
   /* Frees all memory associated with this RMQ structure. */
   ~HybridRMQ();
@@ -43,12 +49,18 @@ public:
    */
   std::size_t rmq(std::size_t low, std::size_t high) const;
 
+  /* Returns the number of bytes of memory used by this RMQ structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const;
+
 private:
   /* TODO: Edit this type to implement it however you'd like. Then, delete this
    * comment.
    */
   
   std::vector<std::size_t> summary;
+  std::vector<std::int32_t> summaryValues; // Values at the summary indices
   const RMQEntry* array;
   std::size_t blockSize;
   /* Copying is disabled. */
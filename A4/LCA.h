@@ -0,0 +1,207 @@
+/******************************************************************************
+ * File: LCA.h
+ *
+ * A lowest common ancestor structure built on top of any of the RMQ types.
+ *
+ * This uses the classic reduction from LCA to RMQ. We walk the tree with a
+ * depth-first search and write down every node each time we visit it (the
+ * Euler tour), along with that node's depth. The lowest common ancestor of two
+ * nodes u and v is then the shallowest node that appears in the tour between
+ * the first visit to u and the first visit to v, which is a range minimum query
+ * over the depths.
+ *
+ * A tree with n nodes has an Euler tour of length 2n - 1, so this takes O(n)
+ * space on top of whatever the RMQ structure needs, and queries take O(1) time
+ * on top of a single RMQ.
+ *
+ * To keep things cache-friendly for trees with millions of nodes, children are
+ * stored in a single flattened array rather than in per-node lists, and the
+ * tour and first-visit tables use 32-bit node numbers. As a result, trees must
+ * have fewer than 2^32 nodes.
+ */
+
+#ifndef LCA_Included
+#define LCA_Included
+
+#include "RMQEntry.h"
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+template <typename RMQ> class LCA {
+public:
+  /* Parent value used to mark the root of the tree. */
+  static constexpr std::size_t kNoParent = std::numeric_limits<std::size_t>::max();
+
+  /* Constructs an LCA structure from a parent array, where parents[v] is the
+   * parent of node v. Exactly one node, the root, should have its parent set
+   * to kNoParent, and every other parent must be a node in the tree.
+   */
+  explicit LCA(const std::vector<std::size_t>& parents) {
+    build(parents);
+  }
+
+  /* Constructs an LCA structure from an undirected adjacency list, rooting the
+   * tree at the specified node.
+   */
+  LCA(const std::vector<std::vector<std::size_t>>& adjacency, std::size_t root) {
+    if (root >= adjacency.size()) throw std::out_of_range("Root is not a node in the tree.");
+
+    /* Orient the edges away from the root to get a parent array. */
+    std::vector<std::size_t> parents(adjacency.size(), kNoParent);
+    std::vector<bool> visited(adjacency.size(), false);
+    std::vector<std::size_t> worklist = { root };
+    visited[root] = true;
+
+    while (!worklist.empty()) {
+      std::size_t node = worklist.back();
+      worklist.pop_back();
+
+      for (std::size_t next: adjacency[node]) {
+        if (next >= adjacency.size()) throw std::out_of_range("Neighbor is not a node in the tree.");
+        if (!visited[next]) {
+          visited[next] = true;
+          parents[next] = node;
+          worklist.push_back(next);
+        }
+      }
+    }
+
+    build(parents);
+  }
+
+  /* Returns the lowest common ancestor of nodes u and v. */
+  std::size_t lca(std::size_t u, std::size_t v) const {
+    std::size_t low  = first[u];
+    std::size_t high = first[v];
+    if (low > high) std::swap(low, high);
+
+    return tour[engine->rmq(low, high + 1)];
+  }
+
+  /* Answers a batch of LCA queries, writing one answer per query into the
+   * result. The first pass looks up the tour positions of every query and the
+   * second runs the range minimum queries, which keeps each pass's memory
+   * accesses independent of one another.
+   */
+  void lca(const std::vector<std::pair<std::size_t, std::size_t>>& queries,
+           std::vector<std::size_t>& result) const {
+    result.resize(queries.size());
+
+    for (std::size_t i = 0; i < queries.size(); i++) {
+      std::size_t low  = first[queries[i].first];
+      std::size_t high = first[queries[i].second];
+      result[i] = low < high? (low << 32) | high : (high << 32) | low;
+    }
+
+    for (std::size_t i = 0; i < queries.size(); i++) {
+      std::size_t low  = result[i] >> 32;
+      std::size_t high = result[i] & 0xFFFFFFFF;
+      result[i] = tour[engine->rmq(low, high + 1)];
+    }
+  }
+
+  /* Returns the number of bytes of memory used by this structure, including
+   * the RMQ structure over the Euler tour.
+   */
+  std::size_t memoryUsage() const {
+    return sizeof(*this) + tour.capacity() * sizeof(tour[0])
+         + depths.capacity() * sizeof(depths[0]) + first.capacity() * sizeof(first[0])
+         + engine->memoryUsage();
+  }
+
+  /* Returns the number of nodes in the tree. */
+  std::size_t size() const {
+    return first.size();
+  }
+
+private:
+  std::vector<std::uint32_t> tour;   // Node at each step of the Euler tour
+  std::vector<RMQEntry>      depths; // Depth of the node at each step
+  std::vector<std::uint32_t> first;  // First step at which each node appears
+  std::unique_ptr<RMQ>       engine; // RMQ structure over the depths
+
+  /* Builds the Euler tour and RMQ structure from a parent array. */
+  void build(const std::vector<std::size_t>& parents) {
+    std::size_t numNodes = parents.size();
+    if (numNodes == 0) throw std::invalid_argument("Tree must have at least one node.");
+    if (2 * numNodes - 1 > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::length_error("Tree is too large for 32-bit Euler tour positions.");
+    }
+
+    /* Flatten the child lists into one array using a counting sort. */
+    std::vector<std::uint32_t> childStart(numNodes + 1, 0);
+    std::size_t root = kNoParent;
+    for (std::size_t v = 0; v < numNodes; v++) {
+      if (parents[v] == kNoParent) {
+        if (root != kNoParent) throw std::invalid_argument("Tree has more than one root.");
+        root = v;
+      } else if (parents[v] >= numNodes) {
+        throw std::out_of_range("Parent is not a node in the tree.");
+      } else {
+        childStart[parents[v] + 1]++;
+      }
+    }
+    if (root == kNoParent) throw std::invalid_argument("Tree has no root.");
+
+    for (std::size_t v = 0; v < numNodes; v++) {
+      childStart[v + 1] += childStart[v];
+    }
+
+    std::vector<std::uint32_t> children(numNodes - 1);
+    std::vector<std::uint32_t> next(childStart.begin(), childStart.end() - 1);
+    for (std::size_t v = 0; v < numNodes; v++) {
+      if (parents[v] != kNoParent) children[next[parents[v]]++] = v;
+    }
+
+    /* Walk the tree iteratively, since real trees can be far too deep for the
+     * call stack. The "next" array is reused as the cursor into each node's
+     * children.
+     */
+    tour.reserve(2 * numNodes - 1);
+    depths.reserve(2 * numNodes - 1);
+    first.assign(numNodes, 0);
+    std::copy(childStart.begin(), childStart.end() - 1, next.begin());
+
+    std::vector<std::uint32_t> stack = { std::uint32_t(root) };
+    first[root] = 0;
+    tour.push_back(root);
+    depths.push_back(RMQEntry(0));
+
+    while (!stack.empty()) {
+      std::uint32_t node = stack.back();
+
+      if (next[node] != childStart[node + 1]) {
+        /* Descend into the next child. */
+        std::uint32_t child = children[next[node]++];
+        stack.push_back(child);
+        first[child] = tour.size();
+        tour.push_back(child);
+        depths.push_back(RMQEntry(stack.size() - 1));
+      } else {
+        /* Return to the parent, which we visit again. */
+        stack.pop_back();
+        if (!stack.empty()) {
+          tour.push_back(stack.back());
+          depths.push_back(RMQEntry(stack.size() - 1));
+        }
+      }
+    }
+
+    if (tour.size() != 2 * numNodes - 1) {
+      throw std::invalid_argument("Parent array does not describe a single tree.");
+    }
+
+    engine = std::make_unique<RMQ>(depths.data(), depths.size());
+  }
+
+  /* Copying is disabled. */
+  LCA(const LCA &) = delete;
+  void operator= (LCA) = delete;
+};
+
+#endif
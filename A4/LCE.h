@@ -0,0 +1,84 @@
+/******************************************************************************
+ * File: LCE.h
+ *
+ * A longest common extension structure built on top of any of the RMQ types.
+ *
+ * The longest common extension of positions i and j in a text is the length of
+ * the longest common prefix of the suffixes starting at i and j. If we build
+ * the suffix array of the text along with its LCP array, that's the minimum LCP
+ * value between the positions of those two suffixes in the suffix array, which
+ * is a range minimum query.
+ *
+ * Building the suffix array and LCP array takes time O(n), so the overall cost
+ * is O(n) plus the cost of building the RMQ structure, and each query costs one
+ * RMQ plus O(1) extra work. Texts must be shorter than 2^31 characters so that
+ * LCP values fit into an RMQEntry.
+ */
+
+#ifndef LCE_Included
+#define LCE_Included
+
+#include "RMQEntry.h"
+#include "SuffixArray.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+template <typename RMQ> class LCE {
+public:
+  /* Constructs an LCE structure for the given text. */
+  explicit LCE(const std::string& text) : length(text.size()) {
+    if (text.size() > std::size_t(std::numeric_limits<std::int32_t>::max())) {
+      throw std::length_error("Text is too long for LCP values to fit in an RMQEntry.");
+    }
+
+    std::vector<std::size_t> suffixArray = buildSuffixArray(text);
+    std::vector<std::size_t> lcpArray    = buildLCPArray(text, suffixArray);
+
+    rank.resize(length);
+    lcp.reserve(length);
+    for (std::size_t i = 0; i < length; i++) {
+      rank[suffixArray[i]] = i;
+      lcp.push_back(RMQEntry(lcpArray[i]));
+    }
+
+    engine = std::make_unique<RMQ>(lcp.data(), lcp.size());
+  }
+
+  /* Returns the length of the longest common prefix of the suffixes starting
+   * at positions i and j. Both positions must be in range.
+   */
+  std::size_t lce(std::size_t i, std::size_t j) const {
+    if (i == j) return length - i;
+
+    std::size_t low  = rank[i];
+    std::size_t high = rank[j];
+    if (low > high) std::swap(low, high);
+
+    return lcp[engine->rmq(low + 1, high + 1)].value();
+  }
+
+  /* Returns the number of bytes of memory used by this structure, including
+   * the RMQ structure over the LCP array.
+   */
+  std::size_t memoryUsage() const {
+    return sizeof(*this) + rank.capacity() * sizeof(rank[0])
+         + lcp.capacity() * sizeof(lcp[0]) + engine->memoryUsage();
+  }
+
+private:
+  std::size_t              length; // Length of the text
+  std::vector<std::size_t> rank;   // Position of each suffix in the suffix array
+  std::vector<RMQEntry>    lcp;    // LCP array, wrapped up for the RMQ structure
+  std::unique_ptr<RMQ>     engine; // RMQ structure over the LCP array
+
+  /* Copying is disabled. */
+  LCE(const LCE &) = delete;
+  void operator= (LCE) = delete;
+};
+
+#endif
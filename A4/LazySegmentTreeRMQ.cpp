@@ -0,0 +1,144 @@
+#include "LazySegmentTreeRMQ.h"
+#include <algorithm> // For max
+using namespace std;
+
+/* Constructor copies the elements into the leaves and builds upward. A tree
+ * over n elements never needs more than 4n slots in heap order.
+ */
+LazySegmentTreeRMQ::LazySegmentTreeRMQ(const RMQEntry* elems, size_t numElems)
+  : nodes(4 * numElems), numElems(numElems) {
+  if (numElems > 0) makeTree(1, 0, numElems, elems);
+}
+
+/* Destructor has nothing to do; the vector cleans up after itself. */
+LazySegmentTreeRMQ::~LazySegmentTreeRMQ() {
+  // Handled automatically
+}
+
+size_t LazySegmentTreeRMQ::rmq(size_t low, size_t high) const {
+  return rmqRec(1, 0, numElems, low, high).second;
+}
+
+void LazySegmentTreeRMQ::rangeAdd(size_t low, size_t high, int64_t delta) {
+  updateRec(1, 0, numElems, low, high, delta, false);
+}
+
+void LazySegmentTreeRMQ::rangeAssign(size_t low, size_t high, int64_t value) {
+  updateRec(1, 0, numElems, low, high, value, true);
+}
+
+/* Looking up a single value is a query over a one-element range. */
+int64_t LazySegmentTreeRMQ::value(size_t index) const {
+  return rmqRec(1, 0, numElems, index, index + 1).first;
+}
+
+size_t LazySegmentTreeRMQ::memoryUsage() const {
+  return sizeof(*this) + nodes.capacity() * sizeof(Node);
+}
+
+/**** Actual Implementation Details ****/
+
+void LazySegmentTreeRMQ::makeTree(size_t node, size_t low, size_t high, const RMQEntry* elems) {
+  nodes[node].pending = 0;
+  nodes[node].assigns = false;
+  
+  /* Base case: Single element is its own minimum. */
+  if (low + 1 == high) {
+    nodes[node].minValue = elems[low].value();
+    nodes[node].minIndex = low;
+    return;
+  }
+  
+  /* Recursive case: Build both halves, then take the smaller minimum. */
+  size_t mid = low + (high - low) / 2;
+  makeTree(2 * node,     low, mid,  elems);
+  makeTree(2 * node + 1, mid, high, elems);
+  pull(node);
+}
+
+void LazySegmentTreeRMQ::applyAdd(size_t node, int64_t delta) {
+  nodes[node].minValue += delta;
+  nodes[node].pending  += delta; // Works for both kinds of note
+}
+
+void LazySegmentTreeRMQ::applyAssign(size_t node, size_t low, int64_t value) {
+  nodes[node].minValue = value;
+  nodes[node].minIndex = low;
+  nodes[node].pending  = value;
+  nodes[node].assigns  = true;
+}
+
+void LazySegmentTreeRMQ::pushDown(size_t node, size_t low, size_t mid) {
+  if (nodes[node].assigns) {
+    applyAssign(2 * node,     low, nodes[node].pending);
+    applyAssign(2 * node + 1, mid, nodes[node].pending);
+  } else if (nodes[node].pending != 0) {
+    applyAdd(2 * node,     nodes[node].pending);
+    applyAdd(2 * node + 1, nodes[node].pending);
+  }
+  
+  nodes[node].pending = 0;
+  nodes[node].assigns = false;
+}
+
+/* Ties go left so that we always report the leftmost minimum. */
+void LazySegmentTreeRMQ::pull(size_t node) {
+  const Node& left  = nodes[2 * node];
+  const Node& right = nodes[2 * node + 1];
+  const Node& smaller = left.minValue <= right.minValue? left : right;
+  
+  nodes[node].minValue = smaller.minValue;
+  nodes[node].minIndex = smaller.minIndex;
+}
+
+pair<int64_t, size_t> LazySegmentTreeRMQ::rmqRec(size_t node, size_t nodeLow, size_t nodeHigh,
+                                                 size_t low, size_t high) const {
+  /* Base case: If the whole range is being searched, return the minimum we
+   * cached earlier on.
+   */
+  if (low <= nodeLow && nodeHigh <= high) return { nodes[node].minValue, nodes[node].minIndex };
+  
+  /* Base case: If everything here was assigned the same value, the leftmost
+   * element of the range is as good as any.
+   */
+  if (nodes[node].assigns) return { nodes[node].pending, max(low, nodeLow) };
+  
+  /* Recursive case: Search one or both halves, then account for any pending
+   * add, which the children don't know about yet.
+   */
+  size_t mid = nodeLow + (nodeHigh - nodeLow) / 2;
+  pair<int64_t, size_t> result;
+  
+  if (high <= mid) {
+    result = rmqRec(2 * node, nodeLow, mid, low, high);
+  } else if (low >= mid) {
+    result = rmqRec(2 * node + 1, mid, nodeHigh, low, high);
+  } else {
+    auto left  = rmqRec(2 * node,     nodeLow, mid,      low, high);
+    auto right = rmqRec(2 * node + 1, mid,     nodeHigh, low, high);
+    result = left.first <= right.first? left : right;
+  }
+  
+  result.first += nodes[node].pending;
+  return result;
+}
+
+void LazySegmentTreeRMQ::updateRec(size_t node, size_t nodeLow, size_t nodeHigh,
+                                   size_t low, size_t high, int64_t amount, bool assigns) {
+  /* Base case: The update covers this whole node, so leave a note. */
+  if (low <= nodeLow && nodeHigh <= high) {
+    if (assigns) applyAssign(node, nodeLow, amount);
+    else         applyAdd(node, amount);
+    return;
+  }
+  
+  /* Recursive case: Make the children current, update whichever halves
+   * overlap the range, then recompute our minimum.
+   */
+  size_t mid = nodeLow + (nodeHigh - nodeLow) / 2;
+  pushDown(node, nodeLow, mid);
+  
+  if (low  < mid) updateRec(2 * node,     nodeLow, mid,      low, high, amount, assigns);
+  if (high > mid) updateRec(2 * node + 1, mid,     nodeHigh, low, high, amount, assigns);
+  pull(node);
+}
@@ -0,0 +1,123 @@
+/******************************************************************************
+ * File: LazySegmentTreeRMQ.h
+ *
+ * A segment tree that, in addition to range minimum queries, supports bulk
+ * updates: adding a value to every element in a range, and assigning a value
+ * to every element in a range. Both updates take time O(log n), as do queries.
+ *
+ * The tree has the same shape as the one in SegmentTreeRMQ: the root covers
+ * the whole array, and each node's children cover the two halves of its range.
+ * Rather than allocating nodes individually, though, the nodes live in a single
+ * array, with the children of node k stored at positions 2k and 2k + 1.
+ *
+ * The trick that makes range updates fast is lazy propagation. When an update
+ * covers a node's entire range, we update that node's minimum and leave a note
+ * on the node saying "this update still needs to be applied to the children,"
+ * rather than walking all the way down. Those notes are pushed one level down
+ * the next time an update needs to look inside the node. There are only two
+ * kinds of notes, because updates compose nicely: an add following an add is
+ * one bigger add, an add following an assignment is a different assignment,
+ * and an assignment wipes out whatever came before it.
+ *
+ * Queries never need to push notes down, which is what lets rmq stay const.
+ * A pending add shifts every value below a node by the same amount, so it
+ * doesn't change where the minimum is; we just account for it when comparing
+ * results on the way back up. A pending assignment makes the whole node's range
+ * equal, so the minimum of any piece of it is that piece's leftmost element.
+ *
+ * Since this structure changes the values it stores, it keeps its own copy of
+ * the elements, as 64-bit integers so that repeated adds can't overflow.
+ */
+
+#ifndef LazySegmentTreeRMQ_Included
+#define LazySegmentTreeRMQ_Included
+
+#include "RMQEntry.h"
+#include "HugePageAllocator.h"
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+class LazySegmentTreeRMQ {
+public:
+  /* Constructs an RMQ structure from the specified array of elements. That
+   * array may be empty.
+   *
+   * The elements are copied, so the array doesn't need to outlive this
+   * structure, and updates made here never write back into it.
+   */
+  LazySegmentTreeRMQ(const RMQEntry* elems, std::size_t numElems);
+
+  /* Frees all memory associated with this RMQ structure. */
+  ~LazySegmentTreeRMQ();
+
+  /* Performs an RMQ over the specified range. You can assume that low < high
+   * and that the bounds are in range and don't need to do any error-handling
+   * if this is not the case.
+   *
+   * The interval here is half-open. That is, the range in question here is
+   * [low, high). Note that this follows the C++ convention, but is slightly
+   * different from how we presented things in lecture.
+   *
+   * This function returns the *index* at which the minimum value occurs,
+   * rather than the minimum value itself. Ties go to the leftmost index.
+   */
+  std::size_t rmq(std::size_t low, std::size_t high) const;
+
+  /* Adds delta to every element in [low, high). As with rmq, low < high and
+   * the bounds must be in range.
+   */
+  void rangeAdd(std::size_t low, std::size_t high, std::int64_t delta);
+
+  /* Sets every element in [low, high) to the given value. As with rmq,
+   * low < high and the bounds must be in range.
+   */
+  void rangeAssign(std::size_t low, std::size_t high, std::int64_t value);
+
+  /* Returns the current value of the element at the given index. */
+  std::int64_t value(std::size_t index) const;
+
+  /* Returns the number of bytes of memory used by this RMQ structure. */
+  std::size_t memoryUsage() const;
+
+private:
+  struct Node {
+    std::int64_t minValue;  // Smallest value in the range, counting the note below
+    std::size_t  minIndex;  // Leftmost index holding that value
+    std::int64_t pending;   // Amount to add, or value to assign, to the children
+    bool         assigns;   // Whether the pending note is an assignment
+  };
+
+  std::vector<Node, HugePageAllocator<Node>> nodes;
+  std::size_t numElems;
+
+  /* Builds the subtree rooted at the given node over [low, high). */
+  void makeTree(std::size_t node, std::size_t low, std::size_t high, const RMQEntry* elems);
+
+  /* Applies an update to an entire node's range, leaving a note for its
+   * children.
+   */
+  void applyAdd(std::size_t node, std::int64_t delta);
+  void applyAssign(std::size_t node, std::size_t low, std::int64_t value);
+
+  /* Hands a node's pending note down to its children. */
+  void pushDown(std::size_t node, std::size_t low, std::size_t mid);
+
+  /* Recomputes a node's minimum from its children. */
+  void pull(std::size_t node);
+
+  /* Recursive helpers for the public operations. Query results are
+   * (value, index) pairs, with values measured as of the given node, which is
+   * to say without any notes left on that node's ancestors.
+   */
+  std::pair<std::int64_t, std::size_t> rmqRec(std::size_t node, std::size_t nodeLow, std::size_t nodeHigh,
+                                              std::size_t low, std::size_t high) const;
+  void updateRec(std::size_t node, std::size_t nodeLow, std::size_t nodeHigh,
+                 std::size_t low, std::size_t high, std::int64_t amount, bool assigns);
+
+  /* Copying is disabled. */
+  LazySegmentTreeRMQ(const LazySegmentTreeRMQ &) = delete;
+  void operator= (LazySegmentTreeRMQ) = delete;
+};
+
+#endif
@@ -0,0 +1,18 @@
+/******************************************************************************
+ * File: MinMaxPosition.h
+ *
+ * Header defining the MinMaxPosition type, which the combined min/max RMQ
+ * types use to report where both extremes of a range are.
+ */
+
+#ifndef MinMaxPosition_Included
+#define MinMaxPosition_Included
+
+#include <cstddef>
+
+/* The indices of the leftmost minimum and the leftmost maximum of a range. */
+struct MinMaxPosition {
+  std::size_t min, max;
+};
+
+#endif
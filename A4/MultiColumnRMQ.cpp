@@ -0,0 +1,90 @@
+#include "MultiColumnRMQ.h"
+#include <bit>
+#include <stdexcept>
+using namespace std;
+
+MultiColumnRMQ::MultiColumnRMQ(const RMQEntry* const* elems, size_t numColumns, size_t numElems)
+  : columns(numColumns) {
+  if (numElems > UINT32_MAX) throw length_error("Too many elements for 32-bit indices.");
+  if (numColumns == 0 || numElems == 0) return;
+
+  levels.resize(bit_width(numElems));
+
+  /* Level 0 is every element by itself, transposed so that each position's
+   * columns sit side by side.
+   */
+  Level& base = levels[0];
+  base.values.resize(numElems * numColumns);
+  base.indices.resize(numElems * numColumns);
+  for (size_t j = 0; j < numElems; j++) {
+    for (size_t c = 0; c < numColumns; c++) {
+      base.values [j * numColumns + c] = elems[c][j].value();
+      base.indices[j * numColumns + c] = j;
+    }
+  }
+
+  /* Each level joins pairs of blocks from the level below. Since block j + half
+   * of a column is exactly half * C entries further along than block j, the
+   * whole level is one flat loop over its entries.
+   */
+  for (size_t k = 1; k < levels.size(); k++) {
+    const Level& prev = levels[k - 1];
+    Level& curr = levels[k];
+
+    size_t offset  = (size_t(1) << (k - 1)) * numColumns;
+    size_t entries = (numElems + 1 - (size_t(1) << k)) * numColumns;
+    curr.values.resize(entries);
+    curr.indices.resize(entries);
+
+    const int32_t*  values  = prev.values.data();
+    const uint32_t* indices = prev.indices.data();
+    int32_t*  outValues  = curr.values.data();
+    uint32_t* outIndices = curr.indices.data();
+    for (size_t i = 0; i < entries; i++) {
+      int32_t  leftValue  = values[i],  rightValue = values[i + offset];
+      uint32_t leftIndex  = indices[i], rightIndex = indices[i + offset];
+      bool right = rightValue < leftValue;
+      outValues[i]  = right? rightValue : leftValue;
+      outIndices[i] = right? rightIndex : leftIndex;
+    }
+  }
+}
+
+/* Every column uses the same level and the same two blocks, so the loop below
+ * is a straight run of independent compares and selects over contiguous
+ * memory. Ties go to the left block, whose index is the smaller one. Both
+ * indices are loaded before the comparison so that the select doesn't turn
+ * into a branch, which would keep the loop from being vectorized.
+ */
+void MultiColumnRMQ::rmq(size_t low, size_t high, size_t* out) const {
+  size_t row = bit_width((high - low - 1) | 1) - 1;
+  const Level& level = levels[row];
+
+  /* Writing through out could change columns as far as the compiler knows, so
+   * take a copy to give the loop a known trip count.
+   */
+  size_t count = columns;
+  size_t left  = low * count;
+  size_t right = (high - (size_t(1) << row)) * count;
+  const int32_t*  leftValues   = level.values.data()  + left;
+  const int32_t*  rightValues  = level.values.data()  + right;
+  const uint32_t* leftIndices  = level.indices.data() + left;
+  const uint32_t* rightIndices = level.indices.data() + right;
+
+  for (size_t c = 0; c < count; c++) {
+    uint32_t leftIndex = leftIndices[c], rightIndex = rightIndices[c];
+    out[c] = rightValues[c] < leftValues[c]? rightIndex : leftIndex;
+  }
+}
+
+size_t MultiColumnRMQ::numColumns() const {
+  return columns;
+}
+
+size_t MultiColumnRMQ::memoryUsage() const {
+  size_t result = sizeof(*this) + levels.capacity() * sizeof(Level);
+  for (const Level& level: levels) {
+    result += level.values.capacity() * sizeof(int32_t) + level.indices.capacity() * sizeof(uint32_t);
+  }
+  return result;
+}
@@ -0,0 +1,77 @@
+/******************************************************************************
+ * File: MultiColumnRMQ.h
+ *
+ * A range minimum query data structure over several parallel columns of the
+ * same length, which answers one range for every column at once.
+ *
+ * This is a sparse table, but the tables for all C columns are interleaved:
+ * level k holds, for each start position j, the minima of the 2^k-element
+ * blocks starting at j in columns 0, 1, ..., C - 1, one after the other. Each
+ * entry stores both the minimum value and its index, in two separate arrays,
+ * so a query never has to go back to the columns themselves.
+ *
+ * A query [low, high) picks the same level and the same two block positions
+ * for every column, so it reads two runs of C consecutive values and two runs
+ * of C consecutive indices, and the per-column comparisons form one loop with
+ * no dependencies between iterations. The compiler turns that loop into SIMD
+ * compares and blends, so each instruction answers a whole vector's worth of
+ * columns. Building the table is the same kind of loop.
+ *
+ * Compared with a SparseTableRMQ per column, this uses the same 8 bytes per
+ * entry per level (but only stores blocks that fit in the array), and a query
+ * touches a handful of cache lines instead of C scattered pairs of them.
+ *
+ * Columns must have fewer than 2^32 elements.
+ */
+
+#ifndef MultiColumnRMQ_Included
+#define MultiColumnRMQ_Included
+
+#include "RMQEntry.h"
+#include "HugePageAllocator.h"
+#include <vector>
+#include <cstdint>
+
+class MultiColumnRMQ {
+public:
+  /* Constructs an RMQ structure over numColumns columns, each of which has
+   * numElems elements. columns[c] points to the elements of column c. There
+   * may be no columns, and the columns may be empty.
+   *
+   * The values are copied into the tables, so the columns aren't used after
+   * construction.
+   */
+  MultiColumnRMQ(const RMQEntry* const* columns, std::size_t numColumns, std::size_t numElems);
+
+  /* Performs an RMQ over the range [low, high) in every column, writing the
+   * index of the leftmost minimum of column c to out[c]. You can assume that
+   * low < high, that the bounds are in range, and that out has room for one
+   * answer per column.
+   */
+  void rmq(std::size_t low, std::size_t high, std::size_t* out) const;
+
+  /* Returns the number of columns. */
+  std::size_t numColumns() const;
+
+  /* Returns the number of bytes of memory used by this RMQ structure. */
+  std::size_t memoryUsage() const;
+
+private:
+  /* Level k has an entry for every column of every 2^k-element block that fits
+   * in the columns. The entry for column c of the block starting at j is at
+   * position j * C + c of both arrays.
+   */
+  struct Level {
+    std::vector<std::int32_t,  HugePageAllocator<std::int32_t>>  values;
+    std::vector<std::uint32_t, HugePageAllocator<std::uint32_t>> indices;
+  };
+
+  std::vector<Level> levels;
+  std::size_t columns;
+
+  /* Copying is disabled. */
+  MultiColumnRMQ(const MultiColumnRMQ &) = delete;
+  void operator= (MultiColumnRMQ) = delete;
+};
+
+#endif
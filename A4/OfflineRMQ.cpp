@@ -0,0 +1,66 @@
+#include "OfflineRMQ.h"
+using namespace std;
+
+namespace {
+  /* Finds the representative of the given index, halving the path as we go. */
+  size_t findRoot(vector<size_t>& parent, size_t index) {
+    while (parent[index] != index) {
+      parent[index] = parent[parent[index]];
+      index = parent[index];
+    }
+    return index;
+  }
+}
+
+vector<size_t> offlineRMQ(const RMQEntry* elems, size_t numElems,
+                          const vector<RMQQuery>& queries) {
+  vector<size_t> result(queries.size());
+  if (queries.empty()) return result;
+
+  /* Bucket the queries by their (inclusive) right endpoint using a counting
+   * sort, so that the sweep can find them without any comparisons.
+   */
+  vector<size_t> bucketStart(numElems + 1, 0);
+  for (const auto& query: queries) {
+    bucketStart[query.high - 1]++;
+  }
+  for (size_t i = 1; i <= numElems; i++) {
+    bucketStart[i] += bucketStart[i - 1];
+  }
+
+  /* Each bucket entry keeps the query's left endpoint alongside its index so
+   * that the sweep doesn't need to chase back into the query list.
+   */
+  struct Pending {
+    size_t low, index;
+  };
+  vector<Pending> order(queries.size());
+  for (size_t i = queries.size(); i > 0; i--) {
+    order[--bucketStart[queries[i - 1].high - 1]] = { queries[i - 1].low, i - 1 };
+  }
+
+  /* Sweep from left to right. Popped indices get merged into the index that
+   * displaced them, which is always the position of the minimum of the range
+   * starting at the popped index and ending at the sweep point.
+   */
+  vector<size_t> parent(numElems);
+  vector<size_t> stack;
+  stack.reserve(numElems);
+
+  size_t next = 0;
+  for (size_t j = 0; j < numElems; j++) {
+    parent[j] = j;
+    while (!stack.empty() && elems[j] < elems[stack.back()]) {
+      parent[stack.back()] = j;
+      stack.pop_back();
+    }
+    stack.push_back(j);
+
+    /* Answer everything ending at j. */
+    for (; next < bucketStart[j + 1]; next++) {
+      result[order[next].index] = findRoot(parent, order[next].low);
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,39 @@
+/******************************************************************************
+ * File: OfflineRMQ.h
+ *
+ * An offline range minimum query solver. When every query is known ahead of
+ * time, there's no need to build an index at all: we can answer the whole
+ * batch in a single left-to-right sweep over the array.
+ *
+ * The sweep maintains the usual Cartesian tree stack (a monotone stack of
+ * indices whose values are no bigger than everything after them) along with a
+ * union-find structure. Whenever an index is popped off the stack, it's merged
+ * into the index that popped it. After processing index j, the representative
+ * of any index i <= j is then the position of the minimum of [i, j]. Bucketing
+ * the queries by their right endpoint lets us answer each query right when the
+ * sweep reaches it, for a total runtime of O((n + q) a(n)), which is linear for
+ * all practical purposes.
+ */
+
+#ifndef OfflineRMQ_Included
+#define OfflineRMQ_Included
+
+#include "RMQEntry.h"
+#include <vector>
+
+/* A single range minimum query over the half-open interval [low, high). */
+struct RMQQuery {
+  std::size_t low, high;
+};
+
+/* Answers every query in the given list over the specified array of elements.
+ * As with the other RMQ types, each query must have low < high with both
+ * bounds in range.
+ *
+ * The result holds, for each query in order, the *index* at which the minimum
+ * value in that range occurs.
+ */
+std::vector<std::size_t> offlineRMQ(const RMQEntry* elems, std::size_t numElems,
+                                    const std::vector<RMQQuery>& queries);
+
+#endif
@@ -0,0 +1,146 @@
+#include "PerfCounters.h"
+#include <cstring>
+using namespace std;
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace {
+  /* Builds the perf_event_attr type/config pair for each event. */
+  void describe(PerfCounters::Event event, perf_event_attr& attr) {
+    auto cacheMiss = [](uint64_t cache) {
+      return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    };
+  
+    switch (event) {
+      case PerfCounters::Cycles:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+      case PerfCounters::Instructions:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+      case PerfCounters::L1DMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cacheMiss(PERF_COUNT_HW_CACHE_L1D);
+        break;
+      case PerfCounters::LLCMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cacheMiss(PERF_COUNT_HW_CACHE_LL);
+        break;
+      case PerfCounters::DTLBMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cacheMiss(PERF_COUNT_HW_CACHE_DTLB);
+        break;
+      case PerfCounters::BranchMisses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+/* All the events go in one group, so that the kernel switches them on and off
+ * together and always schedules them onto the hardware at the same time. The
+ * first event that opens becomes the group leader. It starts out disabled and
+ * the rest follow it.
+ */
+PerfCounters::PerfCounters() {
+  fds.fill(-1);
+  leader = -1;
+  
+  for (size_t i = 0; i < NumEvents; i++) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = leader == -1? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    describe(Event(i), attr);
+    
+    fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+    if (fds[i] == -1 && errorMessage.empty()) {
+      errorMessage = "perf_event_open failed for " + name(Event(i)) + ": " + strerror(errno);
+    }
+    if (fds[i] != -1 && leader == -1) leader = fds[i];
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (int fd: fds) {
+    if (fd != -1) close(fd);
+  }
+}
+
+void PerfCounters::start() {
+  if (leader != -1) ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::stop() {
+  if (leader != -1) ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+uint64_t PerfCounters::total(Event event) const {
+  if (fds[event] == -1) return 0;
+  
+  /* Layout given by the read_format we asked for. */
+  struct {
+    uint64_t value, timeEnabled, timeRunning;
+  } result;
+  
+  if (read(fds[event], &result, sizeof(result)) != sizeof(result)) return 0;
+  if (result.timeRunning == 0) return 0;
+  
+  return static_cast<uint64_t>(double(result.value) * result.timeEnabled / result.timeRunning);
+}
+
+#else
+
+/* Without perf_event_open, nothing is ever available. */
+PerfCounters::PerfCounters() : errorMessage("hardware counters require Linux") {
+  fds.fill(-1);
+  leader = -1;
+}
+PerfCounters::~PerfCounters() {}
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+uint64_t PerfCounters::total(Event) const {
+  return 0;
+}
+
+#endif
+
+bool PerfCounters::available() const {
+  for (int fd: fds) {
+    if (fd != -1) return true;
+  }
+  return false;
+}
+
+bool PerfCounters::available(Event event) const {
+  return fds[event] != -1;
+}
+
+string PerfCounters::name(Event event) {
+  switch (event) {
+    case Cycles:       return "Cycles";
+    case Instructions: return "Instructions";
+    case L1DMisses:    return "L1D misses";
+    case LLCMisses:    return "LLC misses";
+    case DTLBMisses:   return "dTLB misses";
+    case BranchMisses: return "Branch mispredicts";
+    default:           return "Unknown event";
+  }
+}
+
+const string& PerfCounters::error() const {
+  return errorMessage;
+}
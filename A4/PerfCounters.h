@@ -0,0 +1,63 @@
+#ifndef PerfCounters_Included
+#define PerfCounters_Included
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * A type representing a set of hardware performance counters. Like a Timer,
+ * this accumulates counts across repeated start/stop pairs. The counters form
+ * a single group, so they're switched on and off together with one system
+ * call each way. Only user-space events are counted, so the kernel side of
+ * those calls doesn't show up in the totals, but the few user-space
+ * instructions on either side of them, and anything else between start and
+ * stop, do. Callers that need exact per-operation figures should measure an
+ * empty start/stop window and subtract it.
+ *
+ * The counters are read through Linux's perf_event_open. If that isn't
+ * available (a different OS, a container that blocks the system call, or a
+ * virtual machine without a PMU), the affected events simply report as being
+ * unavailable and start/stop become no-ops.
+ */
+class PerfCounters {
+public:
+  enum Event {
+    Cycles, Instructions, L1DMisses, LLCMisses, DTLBMisses, BranchMisses,
+    NumEvents
+  };
+
+  PerfCounters();
+  ~PerfCounters();
+
+  void start();
+  void stop();
+
+  /* Whether any counter at all could be opened. */
+  bool available() const;
+
+  /* Whether the specified counter could be opened. */
+  bool available(Event event) const;
+
+  /* Total count of the specified event, scaled up if the kernel had to share
+   * the hardware counter with other events.
+   */
+  std::uint64_t total(Event event) const;
+
+  /* Human-readable name of an event. */
+  static std::string name(Event event);
+
+  /* Reason the counters couldn't be opened, or empty if they all were. */
+  const std::string& error() const;
+
+private:
+  std::array<int, NumEvents> fds;
+  int leader; // File descriptor of the group leader, or -1 if none opened
+  std::string errorMessage;
+
+  /* Copying is disabled. */
+  PerfCounters(const PerfCounters &) = delete;
+  void operator= (PerfCounters) = delete;
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include "PersistentSegmentTreeRMQ.h"
+#include <stdexcept>
+#include <limits>
+#include <bit>
+using namespace std;
+
+/* Constructor builds version 0. A tree over n elements has 2n - 1 nodes. */
+PersistentSegmentTreeRMQ::PersistentSegmentTreeRMQ(const RMQEntry* elems, size_t numElems)
+  : numElems(numElems) {
+  if (numElems > numeric_limits<uint32_t>::max()) {
+    throw length_error("Too many elements for 32-bit node indices.");
+  }
+  
+  if (numElems > 0) {
+    arena.reserve(2 * numElems - 1);
+    roots.push_back(makeTree(0, numElems, elems));
+  } else {
+    roots.push_back(0);
+  }
+}
+
+/* Destructor has nothing to do; the arena cleans up after itself. */
+PersistentSegmentTreeRMQ::~PersistentSegmentTreeRMQ() {
+  // Handled automatically
+}
+
+size_t PersistentSegmentTreeRMQ::rmq(size_t low, size_t high) const {
+  return rmq(roots.size() - 1, low, high);
+}
+
+size_t PersistentSegmentTreeRMQ::rmq(size_t version, size_t low, size_t high) const {
+  return arena[rmqRec(roots[version], 0, numElems, low, high)].minIndex;
+}
+
+size_t PersistentSegmentTreeRMQ::update(size_t version, size_t index, RMQEntry value) {
+  if (version >= roots.size()) throw out_of_range("No such version.");
+  if (index >= numElems)       throw out_of_range("Index out of range.");
+  
+  /* Look up the root first, since updating may reallocate the arena. */
+  uint32_t root = roots[version];
+  roots.push_back(updateRec(root, 0, numElems, index, value));
+  return roots.size() - 1;
+}
+
+/* A path from the root to a leaf has at most bit_width(n) + 1 nodes. */
+void PersistentSegmentTreeRMQ::reserveUpdates(size_t numUpdates) {
+  arena.reserve(arena.size() + numUpdates * (bit_width(numElems) + 1));
+  roots.reserve(roots.size() + numUpdates);
+}
+
+size_t PersistentSegmentTreeRMQ::numVersions() const {
+  return roots.size();
+}
+
+size_t PersistentSegmentTreeRMQ::numNodes() const {
+  return arena.size();
+}
+
+size_t PersistentSegmentTreeRMQ::memoryUsage() const {
+  return sizeof(*this) + arena.capacity() * sizeof(Node) + roots.capacity() * sizeof(uint32_t);
+}
+
+/**** Actual Implementation Details ****/
+
+/* Node indices are 32 bits, so updates could otherwise wrap around once the
+ * arena holds 2^32 nodes.
+ */
+uint32_t PersistentSegmentTreeRMQ::addNode(const Node& node) {
+  if (arena.size() > numeric_limits<uint32_t>::max()) {
+    throw length_error("Too many nodes for 32-bit node indices.");
+  }
+  arena.push_back(node);
+  return arena.size() - 1;
+}
+
+uint32_t PersistentSegmentTreeRMQ::makeTree(size_t low, size_t high, const RMQEntry* elems) {
+  /* Base case: Single element maps to a leaf. */
+  if (low + 1 == high) {
+    return addNode({ elems[low].value(), uint32_t(low), 0, 0 });
+  }
+  
+  /* Recursive case: Build both halves, then join them. */
+  size_t mid = low + (high - low) / 2;
+  uint32_t left  = makeTree(low, mid, elems);
+  uint32_t right = makeTree(mid, high, elems);
+  return makeParent(left, right);
+}
+
+/* Ties go left so that we always report the leftmost minimum. */
+uint32_t PersistentSegmentTreeRMQ::makeParent(uint32_t left, uint32_t right) {
+  const Node& smaller = arena[left].minValue <= arena[right].minValue? arena[left] : arena[right];
+  Node parent = { smaller.minValue, smaller.minIndex, left, right };
+  return addNode(parent);
+}
+
+uint32_t PersistentSegmentTreeRMQ::updateRec(uint32_t node, size_t nodeLow, size_t nodeHigh,
+                                             size_t index, RMQEntry value) {
+  /* Base case: Make a new leaf with the new value. */
+  if (nodeLow + 1 == nodeHigh) {
+    return addNode({ value.value(), uint32_t(index), 0, 0 });
+  }
+  
+  /* Recursive case: Copy the path down the half holding the index, and share
+   * the other half with the old version.
+   */
+  size_t mid = nodeLow + (nodeHigh - nodeLow) / 2;
+  uint32_t left  = arena[node].left;
+  uint32_t right = arena[node].right;
+  
+  if (index < mid) left  = updateRec(left,  nodeLow, mid,      index, value);
+  else             right = updateRec(right, mid,     nodeHigh, index, value);
+  
+  return makeParent(left, right);
+}
+
+uint32_t PersistentSegmentTreeRMQ::rmqRec(uint32_t node, size_t nodeLow, size_t nodeHigh,
+                                          size_t low, size_t high) const {
+  /* Base case: If the whole range is being searched, this node has it. */
+  if (nodeLow == low && nodeHigh == high) return node;
+  
+  /* Recursive case: Need to search one, or maybe two, ranges. */
+  size_t mid = nodeLow + (nodeHigh - nodeLow) / 2;
+  
+  if (high <= mid) return rmqRec(arena[node].left,  nodeLow, mid,      low, high);
+  if (low  >= mid) return rmqRec(arena[node].right, mid,     nodeHigh, low, high);
+  
+  uint32_t left  = rmqRec(arena[node].left,  nodeLow, mid,      low,  mid);
+  uint32_t right = rmqRec(arena[node].right, mid,     nodeHigh, mid, high);
+  return arena[left].minValue <= arena[right].minValue? left : right;
+}
@@ -0,0 +1,118 @@
+/******************************************************************************
+ * File: PersistentSegmentTreeRMQ.h
+ *
+ * A persistent (versioned) segment tree. Each point update produces a new
+ * version of the array, and every old version stays around and can still be
+ * queried.
+ *
+ * Keeping a full copy of an RMQ structure per version would cost O(n) memory
+ * per update. Instead, we use path copying. Changing one element only changes
+ * the nodes on the path from the root down to that element's leaf, so an
+ * update copies just those O(log n) nodes and points the copies at the
+ * untouched subtrees of the old version. Each version is then identified by
+ * its root, and all versions share structure wherever they agree.
+ *
+ * All nodes live in a single arena and refer to one another by index, which
+ * keeps nodes small (16 bytes) and avoids a separate allocation per node. Nodes
+ * don't store the ranges they cover; those are recomputed on the way down, the
+ * same way that SegmentTreeRMQ splits ranges in half.
+ */
+
+#ifndef PersistentSegmentTreeRMQ_Included
+#define PersistentSegmentTreeRMQ_Included
+
+#include "RMQEntry.h"
+#include "HugePageAllocator.h"
+#include <vector>
+#include <cstdint>
+
+class PersistentSegmentTreeRMQ {
+public:
+  /* Constructs an RMQ structure from the specified array of elements, which
+   * becomes version 0. That array may be empty.
+   *
+   * The elements are copied into the tree, so the array doesn't need to
+   * outlive this structure.
+   */
+  PersistentSegmentTreeRMQ(const RMQEntry* elems, std::size_t numElems);
+
+  /* Frees all memory associated with this RMQ structure. */
+  ~PersistentSegmentTreeRMQ();
+
+  /* Performs an RMQ over the specified range of the most recent version. You
+   * can assume that low < high and that the bounds are in range and don't need
+   * to do any error-handling if this is not the case.
+   *
+   * The interval here is half-open. That is, the range in question here is
+   * [low, high).
+   *
+   * This function returns the *index* at which the minimum value occurs,
+   * rather than the minimum value itself. Ties go to the leftmost index.
+   */
+  std::size_t rmq(std::size_t low, std::size_t high) const;
+
+  /* Performs an RMQ over the specified range as of the given version. */
+  std::size_t rmq(std::size_t version, std::size_t low, std::size_t high) const;
+
+  /* Makes a new version that is a copy of the given version, except that the
+   * element at the given index is replaced with the given value. Returns the
+   * number of the new version. The base version doesn't need to be the most
+   * recent one, so versions can branch.
+   */
+  std::size_t update(std::size_t version, std::size_t index, RMQEntry value);
+
+  /* Sets aside room for the given number of further updates, so that making
+   * them won't have to grow the arena.
+   */
+  void reserveUpdates(std::size_t numUpdates);
+
+  /* Returns the number of versions, including the original array. */
+  std::size_t numVersions() const;
+
+  /* Returns the number of tree nodes, across all versions. Each update adds
+   * O(log n) of them.
+   */
+  std::size_t numNodes() const;
+
+  /* Returns the number of bytes of memory used by this RMQ structure, across
+   * all versions, including any room set aside for later updates. numNodes
+   * gives the number of nodes actually in use.
+   */
+  std::size_t memoryUsage() const;
+
+private:
+  struct Node {
+    std::int32_t  minValue;    // Smallest value in the range
+    std::uint32_t minIndex;    // Leftmost index holding that value
+    std::uint32_t left, right; // Children in the arena, unused for leaves
+  };
+
+  std::vector<Node, HugePageAllocator<Node>> arena; // Every node from every version
+  std::vector<std::uint32_t>                 roots; // Root node of each version
+  std::size_t numElems;
+
+  /* Appends a node to the arena and returns its index. */
+  std::uint32_t addNode(const Node& node);
+
+  /* Builds a tree over [low, high) and returns its root. */
+  std::uint32_t makeTree(std::size_t low, std::size_t high, const RMQEntry* elems);
+
+  /* Appends a node whose minimum is the smaller of its two children's. */
+  std::uint32_t makeParent(std::uint32_t left, std::uint32_t right);
+
+  /* Returns the root of a copy of the tree with one element replaced. */
+  std::uint32_t updateRec(std::uint32_t node, std::size_t nodeLow, std::size_t nodeHigh,
+                          std::size_t index, RMQEntry value);
+
+  /* Performs a query on the tree, returning the index of a node whose
+   * minimum is the answer.
+   */
+  std::uint32_t rmqRec(std::uint32_t node, std::size_t nodeLow, std::size_t nodeHigh,
+                       std::size_t low, std::size_t high) const;
+
+  /* Copying is disabled. */
+  PersistentSegmentTreeRMQ(const PersistentSegmentTreeRMQ &) = delete;
+  void operator= (PersistentSegmentTreeRMQ) = delete;
+};
+
+#endif
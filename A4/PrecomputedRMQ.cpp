@@ -1,18 +1,33 @@
 #include "PrecomputedRMQ.h"
 
 PrecomputedRMQ::PrecomputedRMQ(const RMQEntry* elems, std::size_t numElems) {
+  rebuild(elems, numElems);
+}
+
+/* Rows are cleared and refilled rather than freed, so a rebuild over an array
+ * no larger than the last one reuses the same storage. Rows left over from a
+ * larger array stay allocated but empty.
+ */
+void PrecomputedRMQ::rebuild(const RMQEntry* elems, std::size_t numElems) {
+  if (indexVector.size() < numElems)
+  {
+    indexVector.resize(numElems);
+  }
+  for (auto& row: indexVector)
+  {
+    row.clear();
+  }
+  if (numElems == 0) return;
 
-  indexVector.reserve(numElems);
   for(std::size_t r = 0; r < numElems; r = r + 1)
      { 
-      std::vector<std::size_t> row;
+      std::vector<std::size_t>& row = indexVector[r];
       row.reserve(numElems);
       for(std::size_t c = 0; c != r; c = c + 1)
       {
         row.emplace_back(600);
       }
       row.emplace_back(r);
-      indexVector.emplace_back(row);
       }
       
     std::size_t numElems_SubOne = numElems - 1;
@@ -31,10 +46,7 @@ PrecomputedRMQ::PrecomputedRMQ(const RMQEntry* elems, std::size_t numElems) {
           }
           safe = safe +1;
       }
-  //draw();
   }
- //draw();
-  
 }
 
 PrecomputedRMQ::~PrecomputedRMQ() {
@@ -55,3 +67,11 @@ void PrecomputedRMQ::draw()
         std::cout << std::endl;
 }
 }
+
+std::size_t PrecomputedRMQ::memoryUsage() const {
+  std::size_t result = sizeof(*this) + indexVector.capacity() * sizeof(indexVector[0]);
+  for (const auto& row: indexVector) {
+    result += row.capacity() * sizeof(row[0]);
+  }
+  return result;
+}
@@ -24,6 +24,12 @@ public:
    * structures, nor should you delete it.
    */
   PrecomputedRMQ(const RMQEntry* elems, std::size_t numElems);
+
+  /* Rebuilds this structure over a new array, as if it had just been
+   * constructed from it. The existing rows are reused, so this allocates no
+   * memory unless the new array is larger than any seen before.
+   */
+  void rebuild(const RMQEntry* elems, std::size_t numElems);
   
   /* Frees all memory associated with this RMQ structure. */
   ~PrecomputedRMQ();
@@ -41,6 +47,11 @@ public:
    */
   std::size_t rmq(std::size_t low, std::size_t high) const;
 
+  /* Returns the number of bytes of memory used by this RMQ structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const;
+
   void draw();
 
 private:
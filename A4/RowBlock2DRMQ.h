@@ -0,0 +1,131 @@
+/******************************************************************************
+ * File: RowBlock2DRMQ.h
+ *
+ * A memory-lean two-dimensional range minimum query data structure built out
+ * of one-dimensional RMQ structures.
+ *
+ * Every row of the grid gets its own one-dimensional RMQ structure. The rows
+ * are also grouped into blocks of about sqrt(r) rows, and each block gets a
+ * summary row holding the minimum of each column within the block, along with
+ * a one-dimensional RMQ structure over that summary.
+ *
+ * A query asks the summary of every block it covers completely, plus the rows
+ * of the at most two blocks it covers partially, for O(sqrt r) one-dimensional
+ * queries in total. The space used is that of the row structures over about
+ * rc + c sqrt(r) elements, so with HybridRMQ rows it's a small fraction of
+ * the size of the grid itself.
+ */
+
+#ifndef RowBlock2DRMQ_Included
+#define RowBlock2DRMQ_Included
+
+#include "RMQEntry.h"
+#include "GridPosition.h"
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+template <typename RowRMQ> class RowBlock2DRMQ {
+public:
+  /* Constructs an RMQ structure over the specified grid of elements, which is
+   * stored in row-major order. The grid may be empty.
+   *
+   * As with the one-dimensional types, the elements array must remain valid,
+   * and unchanged, for the lifetime of this data structure.
+   */
+  RowBlock2DRMQ(const RMQEntry* elems, std::size_t numRows, std::size_t numCols)
+    : array(elems), numCols(numCols) {
+    blockSize = std::max<std::size_t>(1, std::round(std::sqrt(numRows)));
+    std::size_t numBlocks = (numRows + blockSize - 1) / blockSize;
+
+    rows.reserve(numRows);
+    for (std::size_t r = 0; r < numRows; r++) {
+      rows.push_back(std::make_unique<RowRMQ>(elems + r * numCols, numCols));
+    }
+
+    /* Fold each block's rows into its summary, one row at a time. */
+    blockMins.resize(numBlocks * numCols);
+    blockMinRows.resize(numBlocks * numCols);
+    for (std::size_t r = 0; r < numRows; r++) {
+      std::size_t base = (r / blockSize) * numCols;
+      for (std::size_t c = 0; c < numCols; c++) {
+        if (r % blockSize == 0 || elems[r * numCols + c] < blockMins[base + c]) {
+          blockMins[base + c]    = elems[r * numCols + c];
+          blockMinRows[base + c] = r;
+        }
+      }
+    }
+
+    blocks.reserve(numBlocks);
+    for (std::size_t b = 0; b < numBlocks; b++) {
+      blocks.push_back(std::make_unique<RowRMQ>(blockMins.data() + b * numCols, numCols));
+    }
+  }
+
+  /* Returns the position of the minimum of the rectangle made of rows
+   * [rowLow, rowHigh) and columns [colLow, colHigh). You can assume that both
+   * ranges are nonempty and in bounds.
+   */
+  GridPosition rmq(std::size_t rowLow, std::size_t rowHigh,
+                   std::size_t colLow, std::size_t colHigh) const {
+    GridPosition best = { SIZE_MAX, SIZE_MAX };
+    RMQEntry bestValue;
+
+    auto consider = [&](std::size_t row, std::size_t col, RMQEntry value) {
+      if (best.row == SIZE_MAX || value < bestValue) {
+        best = { row, col };
+        bestValue = value;
+      }
+    };
+
+    std::size_t r = rowLow;
+    while (r < rowHigh) {
+      if (r % blockSize == 0 && r + blockSize <= rowHigh) {
+        std::size_t base = (r / blockSize) * numCols;
+        std::size_t col  = blocks[r / blockSize]->rmq(colLow, colHigh);
+        consider(blockMinRows[base + col], col, blockMins[base + col]);
+        r += blockSize;
+      } else {
+        std::size_t col = rows[r]->rmq(colLow, colHigh);
+        consider(r, col, array[r * numCols + col]);
+        r++;
+      }
+    }
+
+    return best;
+  }
+
+  /* Returns the number of bytes of memory used by this RMQ structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const {
+    std::size_t result = sizeof(*this) + blockMins.capacity() * sizeof(RMQEntry)
+                       + blockMinRows.capacity() * sizeof(std::uint32_t)
+                       + (rows.capacity() + blocks.capacity()) * sizeof(std::unique_ptr<RowRMQ>);
+    for (const auto& row: rows) {
+      result += row->memoryUsage();
+    }
+    for (const auto& block: blocks) {
+      result += block->memoryUsage();
+    }
+    return result;
+  }
+
+private:
+  const RMQEntry* array;
+  std::size_t numCols;
+  std::size_t blockSize;
+
+  std::vector<std::unique_ptr<RowRMQ>> rows;         // RMQ over each row
+  std::vector<RMQEntry>                blockMins;    // Column minima of each block
+  std::vector<std::uint32_t>           blockMinRows; // Row each column minimum came from
+  std::vector<std::unique_ptr<RowRMQ>> blocks;       // RMQ over each block's minima
+
+  /* Copying is disabled. */
+  RowBlock2DRMQ(const RowBlock2DRMQ &) = delete;
+  void operator= (RowBlock2DRMQ) = delete;
+};
+
+#endif
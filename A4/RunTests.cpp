@@ -1,9 +1,27 @@
+#include "AdaptiveRunRMQ.h"
+#include "CachedRMQ.h"
+#include "ExternalRMQ.h"
 #include "FastestRMQ.h"
 #include "FischerHeunRMQ.h"
+#include "HugePageAllocator.h"
+#include "HybridMinMaxRMQ.h"
 #include "HybridRMQ.h"
+#include "LCA.h"
+#include "LCE.h"
+#include "LazySegmentTreeRMQ.h"
+#include "MultiColumnRMQ.h"
+#include "OfflineRMQ.h"
+#include "PerfCounters.h"
+#include "PersistentSegmentTreeRMQ.h"
 #include "PrecomputedRMQ.h"
+#include "RowBlock2DRMQ.h"
 #include "SegmentTreeRMQ.h"
+#include "SparseTable2DRMQ.h"
+#include "SparseTableMinMaxRMQ.h"
 #include "SparseTableRMQ.h"
+#include "TinyRMQ.h"
+#include "TopK.h"
+#include "WaveletMatrixRMQ.h"
 #include "RMQEntry.h"
 #include "Timer.h"
 #include <iostream>
@@ -19,16 +37,60 @@
 #include <functional>
 #include <cctype>
 #include <sstream>
+#include <iomanip>
 #include <memory>
+#include <optional>
+#include <fstream>
+#include <cmath>
+#include <limits>
+#include <filesystem>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unistd.h>
 using namespace std;
 
 namespace {
+  /* Temporary files that exist right now. abort() skips destructors, so
+   * abortProgram deletes these itself.
+   */
+  unordered_set<string> liveTempFiles;
+  
   /* Aborts with a nice error message. */
   [[ noreturn ]] void abortProgram() {
     cout << "Run this program under gdb and backtrace for more information." << endl;
+    for (const auto& filename: liveTempFiles) {
+      error_code ignored;
+      filesystem::remove(filename, ignored);
+    }
     abort();
   }
   
+  /* A temporary file that's deleted when this goes out of scope, whether
+   * that's normally, through an exception, or through abortProgram.
+   */
+  class TempFile {
+  public:
+    explicit TempFile(const string& filename) : filename(filename) {
+      liveTempFiles.insert(filename);
+    }
+    ~TempFile() {
+      error_code ignored;
+      filesystem::remove(filename, ignored);
+      liveTempFiles.erase(filename);
+    }
+    
+    const string& name() const {
+      return filename;
+    }
+    
+  private:
+    string filename;
+    
+    /* Copying is disabled. */
+    TempFile(const TempFile &) = delete;
+    void operator= (TempFile) = delete;
+  };
+  
   /* Adds commas to a numeric value to make it easier to read. */
   template <typename Integer> string addCommasTo(Integer n) {
     /* Negative numbers don't play well with mods. */
@@ -57,7 +119,8 @@ namespace {
   
   /* Master set of all possible command-line switches. */
   const unordered_set<string> kAllSwitches = {
-    "-rmq", "-seed", "-output"
+    "-rmq", "-seed", "-output", "-mode", "-counters", "-hugepages", "-input", "-rebuild",
+    "-sizes", "-builds", "-queries", "-trials", "-baseline"
   };
   
   /* Type representing something that can print information about how tests are going. */
@@ -67,8 +130,25 @@ namespace {
   
     virtual void startTest(size_t numElems, size_t numBuilds, size_t numQueries) = 0;
     virtual void reportResult(size_t buildTime, size_t queryTime) = 0;
+    
+    /* Reports some other named measurement about the current test. */
+    virtual void reportMetric(const string& name, double value, const string& unit) = 0;
+    
+    /* Signals that all results for the current test have been reported. */
+    virtual void endTest() {}
   };
   
+  /* Formats a measurement, adding commas if it happens to be a whole number. */
+  string formatValue(double value) {
+    if (value == static_cast<double>(static_cast<long long>(value))) {
+      return addCommasTo(static_cast<long long>(value));
+    }
+    
+    ostringstream result;
+    result << value;
+    return result.str();
+  }
+  
   /* Default printer. */
   class PrettyPrinter: public Printer {
   public:
@@ -82,22 +162,54 @@ namespace {
       cout << "  Mean build time: " << addCommasTo(buildTime) << " ns" << endl;
       cout << "  Mean query time: " << addCommasTo(queryTime) << " ns" << endl;
     }
+    
+    void reportMetric(const string& name, double value, const string& unit) override {
+      cout << "  " << name << ": " << formatValue(value);
+      if (!unit.empty()) cout << " " << unit;
+      cout << endl;
+    }
   };
   
-  /* CSV printer. */
+  /* CSV printer. Since different tests report different measurements, each
+   * row is buffered until the test ends, and the header is written out based
+   * on the columns in the first row.
+   */
   class CSVPrinter: public Printer {
   public:
-    CSVPrinter() {
-      cout << "Elements,Mean Build Time,Mean Query Time" << endl;
-    }
-  
-    void startTest(size_t numElems, size_t numBuilds, size_t numQueries) override {
-      cout << numElems << flush;
+    void startTest(size_t numElems, size_t, size_t) override {
+      columns = { "Elements" };
+      row = to_string(numElems);
     }
     
     virtual void reportResult(size_t buildTime, size_t queryTime) override {
-      cout << "," << buildTime << "," << queryTime << endl;
+      columns.push_back("Mean Build Time");
+      columns.push_back("Mean Query Time");
+      row += "," + to_string(buildTime) + "," + to_string(queryTime);
+    }
+    
+    void reportMetric(const string& name, double value, const string&) override {
+      columns.push_back(name);
+      
+      ostringstream converter;
+      converter << setprecision(12) << value;
+      row += "," + converter.str();
+    }
+    
+    void endTest() override {
+      if (!headerPrinted) {
+        for (size_t i = 0; i < columns.size(); i++) {
+          cout << (i == 0? "" : ",") << columns[i];
+        }
+        cout << endl;
+        headerPrinted = true;
+      }
+      cout << row << endl;
     }
+    
+  private:
+    vector<string> columns;
+    string row;
+    bool headerPrinted = false;
   };
   
   
@@ -105,12 +217,169 @@ namespace {
   struct TestParameters {
     size_t seed;
     shared_ptr<Printer> printer;
+    bool counters = false; // Whether to read hardware performance counters
+    bool hugePages = false; // Whether large tables should use huge pages
+    string input = "random"; // Shape of the arrays runTests generates
+    bool rebuild = false;    // Whether runTests reuses one engine across builds
+    
+    /* Grid used by the benchmark mode. */
+    vector<size_t> benchmarkSizes;
+    size_t benchmarkBuilds, benchmarkQueries, benchmarkTrials;
+    string baselineFile;   // Results to compare against, if any
+  };
+  
+  /* Makes a set of hardware counters if we were asked for them, or returns
+   * null otherwise.
+   */
+  unique_ptr<PerfCounters> makeCounters(const TestParameters& params) {
+    return params.counters? make_unique<PerfCounters>() : nullptr;
+  }
+  
+  /* Returns the peak resident set size of this process so far, in kilobytes. */
+  size_t peakRSSInKB() {
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_maxrss;
+  }
+  
+  /* Reports how much memory a structure used, along with the peak memory of
+   * the process as a whole. Peak RSS never goes down, so it reflects the largest
+   * test run so far rather than the current one.
+   */
+  void reportMemory(const TestParameters& params, size_t bytes, size_t numElems) {
+    params.printer->reportMetric("Memory usage", bytes, "bytes");
+    params.printer->reportMetric("Bytes / element", numElems == 0? 0.0 : double(bytes) / numElems, "");
+    params.printer->reportMetric("Peak RSS", peakRSSInKB(), "KB");
+  }
+  
+  /* Measures what each hardware counter picks up over an empty timed window,
+   * laid out exactly as runTests lays out its windows: the counters go on, the
+   * timer starts and stops, and the counters go off. The timer's own reads
+   * land inside the counted window, and this is what gets taken back out of
+   * the per-operation figures. (The other order would put the counters' system
+   * calls inside the timed window instead, which costs far more.)
+   */
+  array<double, PerfCounters::NumEvents> measureCounterOverhead() {
+    constexpr size_t kWindows = 10000;
+    
+    PerfCounters counters;
+    Timer timer;
+    for (size_t i = 0; i < kWindows; i++) {
+      counters.start();
+      timer.start();
+      timer.stop();
+      counters.stop();
+    }
+    
+    array<double, PerfCounters::NumEvents> result;
+    for (size_t i = 0; i < PerfCounters::NumEvents; i++) {
+      auto event = PerfCounters::Event(i);
+      result[i] = counters.available(event)? double(counters.total(event)) / kWindows : 0;
+    }
+    return result;
+  }
+  
+  /* Reports the average of each available hardware counter over some number of
+   * operations, each timed in its own window, less the cost of an empty window.
+   * If some counters can't be read, we say so once and then carry on with
+   * whatever we have.
+   */
+  void reportCounters(const TestParameters& params, const PerfCounters* counters,
+                      const string& operation, size_t count) {
+    if (counters == nullptr) return;
+    static const auto overhead = measureCounterOverhead();
+    
+    static bool warned = false;
+    if (!counters->error().empty() && !warned) {
+      cerr << "Warning: some hardware counters are unavailable (" << counters->error() << ")." << endl;
+      warned = true;
+    }
+    
+    for (size_t i = 0; i < PerfCounters::NumEvents; i++) {
+      auto event = PerfCounters::Event(i);
+      if (counters->available(event)) {
+        double perOperation = double(counters->total(event)) / count - overhead[i];
+        params.printer->reportMetric(PerfCounters::name(event) + " / " + operation,
+                                     max(perOperation, 0.0), "");
+      }
+    }
+  }
+  
+  /* Names of the array shapes runTests can generate. */
+  const unordered_set<string> kAllInputs = {
+    "random", "sorted", "nearlysorted", "sawtooth"
+  };
+  
+  /* Fills an array with values in [0, n) of the given shape:
+   *
+   *   random:       every value independent.
+   *   sorted:       random values in nondecreasing order.
+   *   nearlysorted: sorted, then about one pair in a thousand swapped.
+   *   sawtooth:     ascending ramps of about sqrt(n) values, each dropping back
+   *                 down to zero.
+   */
+  void fillArray(vector<RMQEntry>& data, const string& input, mt19937& generator) {
+    if (data.empty()) return;
+    uniform_int_distribution<size_t> dist(0, data.size() - 1);
+    
+    if (input == "sawtooth") {
+      size_t period = max<size_t>(1, sqrt(data.size()));
+      for (size_t i = 0; i < data.size(); i++) {
+        data[i] = RMQEntry(i % period);
+      }
+      return;
+    }
+    
+    for (auto& elem: data) {
+      elem = RMQEntry(dist(generator));
+    }
+    if (input == "random") return;
+    
+    sort(data.begin(), data.end());
+    if (input == "nearlysorted") {
+      for (size_t swaps = max<size_t>(1, data.size() / 1000); swaps > 0; swaps--) {
+        swap(data[dist(generator)], data[dist(generator)]);
+      }
+    }
+  }
+  
+  /* RMQ types that can be rebuilt in place over a new array. */
+  template <typename RMQ> concept Rebuildable = requires(RMQ rmq, const RMQEntry* elems, size_t numElems) {
+    rmq.rebuild(elems, numElems);
   };
   
-  /* Tests and reports timing information about the specifed RMQ structure. */
+  /* Times fresh construction over arrays like the ones runTests builds over,
+   * returning the total time for all the builds. This runs as its own pass
+   * before the rebuilds it's compared against, and draws its arrays from a
+   * copy of the generator so the main pass sees the same arrays either way.
+   */
+  template <typename RMQ> size_t timeFreshBuilds(size_t numElems, size_t numBuilds,
+                                                 mt19937 generator, const TestParameters& params) {
+    Timer timer;
+    vector<RMQEntry> data(numElems);
+    for (size_t build = 0; build < numBuilds; build++) {
+      fillArray(data, params.input, generator);
+      
+      timer.start();
+      RMQ fresh(data.data(), data.size());
+      timer.stop();
+    }
+    return timer.elapsed();
+  }
+  
+  /* Tests and reports timing information about the specifed RMQ structure.
+   * Normally each build constructs a fresh structure. With -rebuild on, the
+   * structure is constructed once, untimed, at each size, and every timed
+   * build rebuilds it in place. The time a fresh build takes is reported
+   * alongside.
+   */
   template <typename RMQ> void runTests(size_t min, size_t max, size_t step,
                                         size_t numBuilds, size_t numQueries,
                                         const TestParameters& params) {
+    if (params.rebuild && !Rebuildable<RMQ>) {
+      throw runtime_error("This RMQ type can't be rebuilt in place.");
+    }
+    
     /* We need a random source in order to produce values. */
     mt19937 generator(params.seed);
     
@@ -118,24 +387,46 @@ namespace {
       params.printer->startTest(numElems, numBuilds, numQueries);
     
       Timer buildTimer, queryTimer;
+      auto buildCounters = makeCounters(params);
+      auto queryCounters = makeCounters(params);
+      size_t memory = 0;
       uniform_int_distribution<size_t> dist(0, numElems - 1);
       
       /* For efficiency, only make one array, and then keep repeatedly filling it in. */
       vector<RMQEntry> data(numElems);
+      optional<RMQ> engine;
+      
+      size_t freshTime = 0;
+      if (params.rebuild) {
+        freshTime = timeFreshBuilds<RMQ>(numElems, numBuilds, generator, params);
+        engine.emplace(data.data(), data.size());
+      }
       
       for (size_t build = 0; build < numBuilds; build++) {
-        /* Fill our vector with a bunch of random elements. */
-        for (size_t i = 0; i < numElems; i++) {
-          data[i] = RMQEntry(dist(generator));
-        }
+        /* Fill our vector with elements of the requested shape. */
+        fillArray(data, params.input, generator);
         
         /* Our reference answer. */
         SegmentTreeRMQ answer(data.data(), data.size());
         
-        /* The answer being tested. */
+        /* The answer being tested. The old one, if we aren't reusing it, is
+         * destroyed before the timer starts, as it would be if it went out of
+         * scope at the end of the last build.
+         */
+        bool reuse = params.rebuild;
+        if (!reuse) engine.reset();
+        
+        if (buildCounters) buildCounters->start();
         buildTimer.start();
-        RMQ tested(data.data(), data.size());
+        if constexpr (Rebuildable<RMQ>) {
+          if (reuse) engine->rebuild(data.data(), data.size());
+        }
+        if (!reuse) engine.emplace(data.data(), data.size());
         buildTimer.stop();
+        if (buildCounters) buildCounters->stop();
+        
+        const RMQ& tested = *engine;
+        memory = tested.memoryUsage();
         
         /* Pummel it with queries. */
         for (size_t query = 0; query < numQueries; query++) {
@@ -150,9 +441,11 @@ namespace {
           /* See what answers we get back. */
           size_t ours = answer.rmq(low, high);
           
+          if (queryCounters) queryCounters->start();
           queryTimer.start();
           size_t theirs = tested.rmq(low, high);
           queryTimer.stop();
+          if (queryCounters) queryCounters->stop();
           
           /* Confirm the answer is in range. */
           if (theirs >= numElems) {
@@ -171,81 +464,1816 @@ namespace {
       
       /* Report statistics. */
       params.printer->reportResult(buildTimer.elapsed() / numBuilds, queryTimer.elapsed() / (numQueries * numBuilds));
+      if (params.rebuild) {
+        params.printer->reportMetric("Fresh build time", freshTime / numBuilds, "ns");
+        params.printer->reportMetric("Rebuild speedup", double(freshTime) / buildTimer.elapsed(), "x");
+      }
+      reportCounters(params, buildCounters.get(), "build", numBuilds);
+      reportCounters(params, queryCounters.get(), "query", numQueries * numBuilds);
+      reportMemory(params, memory, numElems);
+      params.printer->endTest();
     }                                                                        
   }
   
+  /* Rebuilds one structure over arrays that grow and shrink, checking after
+   * each rebuild that it answers queries correctly, and that a rebuild over an
+   * array no larger than any before it reused its tables as they were rather
+   * than allocating. Every table's capacity shows up in memoryUsage, so that
+   * staying put means none of them changed.
+   */
+  template <typename RMQ> void runRebuildTests(const vector<size_t>& sizes, size_t numQueries,
+                                               const TestParameters& params) {
+    mt19937 generator(params.seed);
+    
+    vector<RMQEntry> data(sizes.front());
+    fillArray(data, params.input, generator);
+    RMQ tested(data.data(), data.size());
+    size_t largest = sizes.front();
+    
+    for (size_t numElems: sizes) {
+      data.assign(numElems, RMQEntry());
+      fillArray(data, params.input, generator);
+      
+      size_t memoryBefore = tested.memoryUsage();
+      tested.rebuild(data.data(), data.size());
+      if (numElems <= largest && tested.memoryUsage() != memoryBefore) {
+        cerr << "Error: rebuilding at " << numElems << " elements changed the memory used from "
+             << memoryBefore << " to " << tested.memoryUsage() << " bytes." << endl;
+        abortProgram();
+      }
+      largest = max(largest, numElems);
+      
+      SegmentTreeRMQ answer(data.data(), data.size());
+      uniform_int_distribution<size_t> dist(0, numElems - 1);
+      for (size_t query = 0; query < numQueries; query++) {
+        size_t low  = dist(generator);
+        size_t high = dist(generator);
+        if (low > high) swap(low, high);
+        high++;
+        
+        if (data[answer.rmq(low, high)] != data[tested.rmq(low, high)]) {
+          cerr << "Error: query after rebuilding at " << numElems << " elements produced the wrong answer." << endl;
+          abortProgram();
+        }
+      }
+    }
+  }
+  
   /* Tests the specified RMQ data structure on a variety of inputs, checking the results produced. */
   template <typename RMQ> void testRMQ(const TestParameters& params) {
     /*             min     max     step  builds queries */
     runTests<RMQ>(     1,     25,      1, 10000,    100, params);
     runTests<RMQ>(  1000,   5000,   1000, 1000,   10000, params);
     runTests<RMQ>(100000, 500000, 100000, 5,    1000000, params);
+    
+    /* Larger, then smaller, then larger again. */
+    if constexpr (Rebuildable<RMQ>) {
+      if (params.rebuild) runRebuildTests<RMQ>({ 2000, 100, 1, 37, 1000, 2000 }, 10000, params);
+    }
     cout << "All tests completed!" << endl;
   }
-
-  /* Parses the command-line arguments by building a map from flags to values. */
-  auto parseArguments(int argc, const char* argv[]) {
-    unordered_map<string, string> result;
+  
+  /* The largest array a type should be built over. PrecomputedRMQ takes
+   * quadratic space, so anything much past this would exhaust memory.
+   */
+  const size_t kNoSizeLimit = numeric_limits<size_t>::max();
+  template <typename RMQ> constexpr size_t kMaxElems = kNoSizeLimit;
+  template <> constexpr size_t kMaxElems<PrecomputedRMQ> = 10000;
+  
+  /* Tests and reports timing information about answering LCA queries on random
+   * trees using the specified RMQ structure.
+   */
+  template <typename RMQ> void runLCATests(size_t min, size_t max, size_t step,
+                                           size_t numBuilds, size_t numQueries,
+                                           const TestParameters& params) {
+    mt19937 generator(params.seed);
     
-    for (int i = 1; i < argc; i += 2) {
-      string flag = argv[i];
-      if (!kAllSwitches.count(flag)) throw runtime_error("Unknown command-line switch: " + flag);
+    for (size_t numNodes = min; numNodes <= max; numNodes += step) {
+      params.printer->startTest(numNodes, numBuilds, numQueries);
       
-      if (i + 1 == argc) throw runtime_error("Command line switch " + flag + " missing argument.");
+      Timer buildTimer, queryTimer;
+      uniform_int_distribution<size_t> nodeDist(0, numNodes - 1);
       
-      if (result.count(flag)) throw runtime_error("Duplicate command-line switch: " + flag);
+      vector<size_t> parents(numNodes);
+      vector<size_t> depths(numNodes);
+      vector<pair<size_t, size_t>> queries(numQueries);
+      vector<size_t> answers;
+      size_t memory = 0;
       
-      result[flag] = argv[i + 1];
+      for (size_t build = 0; build < numBuilds; build++) {
+        /* Make a random tree by hanging each node off some earlier node. */
+        parents[0] = LCA<RMQ>::kNoParent;
+        depths[0]  = 0;
+        for (size_t v = 1; v < numNodes; v++) {
+          parents[v] = uniform_int_distribution<size_t>(0, v - 1)(generator);
+          depths[v]  = depths[parents[v]] + 1;
+        }
+        
+        for (auto& query: queries) {
+          query = { nodeDist(generator), nodeDist(generator) };
+        }
+        
+        buildTimer.start();
+        LCA<RMQ> tested(parents);
+        buildTimer.stop();
+        memory = tested.memoryUsage();
+        
+        queryTimer.start();
+        tested.lca(queries, answers);
+        queryTimer.stop();
+        
+        /* Check everything by walking up the tree. */
+        for (size_t i = 0; i < numQueries; i++) {
+          size_t u = queries[i].first, v = queries[i].second;
+          while (depths[u] > depths[v]) u = parents[u];
+          while (depths[v] > depths[u]) v = parents[v];
+          while (u != v) {
+            u = parents[u];
+            v = parents[v];
+          }
+          
+          if (answers[i] != u) {
+            cerr << "Error: LCA query produced the wrong answer. " << endl;
+            abortProgram();
+          }
+        }
+      }
+      
+      params.printer->reportResult(buildTimer.elapsed() / numBuilds, queryTimer.elapsed() / (numQueries * numBuilds));
+      reportMemory(params, memory, numNodes);
+      params.printer->endTest();
+    }
+  }
+  
+  /* RMQ types that support range updates. */
+  template <typename RMQ> concept RangeUpdatable = requires(RMQ rmq, size_t index, int64_t amount) {
+    rmq.rangeAdd(index, index, amount);
+    rmq.rangeAssign(index, index, amount);
+  };
+  
+  /* Tests and reports timing information about a structure supporting range
+   * updates, mixing updates and queries in several different proportions. The
+   * answers are checked against a plain array that's updated by brute force.
+   */
+  template <typename RMQ> void runUpdateTests(size_t min, size_t max, size_t step,
+                                              size_t numBuilds, size_t numOps,
+                                              const TestParameters& params) {
+    mt19937 generator(params.seed);
+    
+    for (size_t numElems = min; numElems <= max; numElems += step) {
+      for (size_t updatePercent: { 0, 10, 50, 90 }) {
+        params.printer->startTest(numElems, numBuilds, numOps);
+        
+        Timer buildTimer, queryTimer, updateTimer;
+        size_t numQueries = 0, numUpdates = 0;
+        uniform_int_distribution<size_t> dist(0, numElems - 1);
+        uniform_int_distribution<size_t> percent(0, 99);
+        uniform_int_distribution<int64_t> delta(-1000, 1000);
+        
+        vector<RMQEntry> data(numElems);
+        vector<int64_t> values(numElems);
+        
+        for (size_t build = 0; build < numBuilds; build++) {
+          for (size_t i = 0; i < numElems; i++) {
+            data[i]   = RMQEntry(dist(generator));
+            values[i] = data[i].value();
+          }
+          
+          buildTimer.start();
+          RMQ tested(data.data(), data.size());
+          buildTimer.stop();
+          
+          for (size_t op = 0; op < numOps; op++) {
+            size_t low  = dist(generator);
+            size_t high = dist(generator);
+            if (low > high) swap(low, high);
+            high++;
+            
+            if (percent(generator) < updatePercent) {
+              /* Half the updates are adds and half are assignments. */
+              int64_t amount = delta(generator);
+              bool assigns = percent(generator) < 50;
+              
+              updateTimer.start();
+              if (assigns) tested.rangeAssign(low, high, amount);
+              else         tested.rangeAdd(low, high, amount);
+              updateTimer.stop();
+              numUpdates++;
+              
+              for (size_t i = low; i < high; i++) {
+                values[i] = assigns? amount : values[i] + amount;
+              }
+            } else {
+              queryTimer.start();
+              size_t theirs = tested.rmq(low, high);
+              queryTimer.stop();
+              numQueries++;
+              
+              if (theirs < low || theirs >= high) {
+                cerr << "Error: query produced an answer that was out of bounds." << endl;
+                abortProgram();
+              }
+              if (values[theirs] != *min_element(values.begin() + low, values.begin() + high)) {
+                cerr << "Error: query produced the wrong answer. " << endl;
+                abortProgram();
+              }
+            }
+          }
+        }
+        
+        params.printer->reportResult(buildTimer.elapsed() / numBuilds,
+                                     numQueries == 0? 0 : queryTimer.elapsed() / numQueries);
+        params.printer->reportMetric("Update percentage", updatePercent, "%");
+        params.printer->reportMetric("Mean update time", numUpdates == 0? 0 : updateTimer.elapsed() / numUpdates, "ns");
+        params.printer->endTest();
+      }
     }
+  }
+  
+  /* Tests a structure supporting range updates under several mixes of updates
+   * and queries.
+   */
+  template <typename RMQ> void testUpdates(const TestParameters& params) {
+    /*                    min     max    step builds     ops */
+    runUpdateTests<RMQ>(  1000,   5000,  1000,    10,  10000, params);
+    runUpdateTests<RMQ>(100000, 100000,     1,     1,  10000, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* RMQ types that keep old versions around after updates. */
+  template <typename RMQ> concept Versioned = requires(RMQ rmq, size_t index, RMQEntry value) {
+    rmq.update(index, index, value);
+    rmq.rmq(index, index, index);
+    rmq.numVersions();
+    rmq.numNodes();
+    rmq.reserveUpdates(index);
+  };
+  
+  /* Tests and reports timing information about a persistent structure. Each
+   * build makes a chain of point-update versions (half of them branching off a
+   * random older version rather than the newest one), then queries random
+   * versions. Every version is kept as a plain array to check the answers.
+   */
+  template <typename RMQ> void runVersionTests(size_t min, size_t max, size_t step,
+                                               size_t numBuilds, size_t numUpdates, size_t numQueries,
+                                               const TestParameters& params) {
+    mt19937 generator(params.seed);
     
-    return result;
+    for (size_t numElems = min; numElems <= max; numElems += step) {
+      params.printer->startTest(numElems, numBuilds, numQueries);
+      
+      Timer buildTimer, updateTimer, queryTimer;
+      size_t bytesPerVersion = 0, nodesPerVersion = 0;
+      uniform_int_distribution<size_t> dist(0, numElems - 1);
+      
+      for (size_t build = 0; build < numBuilds; build++) {
+        vector<vector<RMQEntry>> versions(1, vector<RMQEntry>(numElems));
+        for (size_t i = 0; i < numElems; i++) {
+          versions[0][i] = RMQEntry(dist(generator));
+        }
+        
+        buildTimer.start();
+        RMQ tested(versions[0].data(), numElems);
+        buildTimer.stop();
+        size_t initialMemory = tested.memoryUsage();
+        size_t initialNodes  = tested.numNodes();
+        
+        /* Grow the storage up front, so that the update timings don't
+         * include the occasional copy of everything built so far. The memory
+         * growth per version counts that reserved room, while the nodes per
+         * version count only what the updates actually used.
+         */
+        tested.reserveUpdates(numUpdates);
+        
+        for (size_t update = 0; update < numUpdates; update++) {
+          size_t base = generator() % 2 == 0? versions.size() - 1 : generator() % versions.size();
+          size_t index = dist(generator);
+          RMQEntry value(dist(generator));
+          
+          updateTimer.start();
+          size_t version = tested.update(base, index, value);
+          updateTimer.stop();
+          
+          versions.push_back(versions[base]);
+          versions.back()[index] = value;
+          if (version + 1 != versions.size()) {
+            cerr << "Error: update produced an unexpected version number." << endl;
+            abortProgram();
+          }
+        }
+        bytesPerVersion = (tested.memoryUsage() - initialMemory) / std::max<size_t>(numUpdates, 1);
+        nodesPerVersion = (tested.numNodes() - initialNodes) / std::max<size_t>(numUpdates, 1);
+        
+        for (size_t query = 0; query < numQueries; query++) {
+          size_t version = generator() % versions.size();
+          size_t low  = dist(generator);
+          size_t high = dist(generator);
+          if (low > high) swap(low, high);
+          high++;
+          
+          queryTimer.start();
+          size_t theirs = tested.rmq(version, low, high);
+          queryTimer.stop();
+          
+          const auto& data = versions[version];
+          if (theirs < low || theirs >= high) {
+            cerr << "Error: query produced an answer that was out of bounds." << endl;
+            abortProgram();
+          }
+          if (data[theirs] != *min_element(data.begin() + low, data.begin() + high)) {
+            cerr << "Error: query produced the wrong answer. " << endl;
+            abortProgram();
+          }
+        }
+      }
+      
+      params.printer->reportResult(buildTimer.elapsed() / numBuilds, queryTimer.elapsed() / (numQueries * numBuilds));
+      params.printer->reportMetric("Mean update time", updateTimer.elapsed() / std::max<size_t>(numUpdates * numBuilds, 1), "ns");
+      params.printer->reportMetric("Nodes / version", nodesPerVersion, "");
+      params.printer->reportMetric("Memory growth / version", bytesPerVersion, "bytes");
+      params.printer->endTest();
+    }
   }
   
-  /* Converts a string to lower-case. */
-  string toLowerCase(string input) {
-    transform(input.begin(), input.end(), input.begin(), ::tolower);
-    return input;
+  /* Tests a persistent structure over many versions. */
+  template <typename RMQ> void testVersions(const TestParameters& params) {
+    /*                     min     max    step builds updates queries */
+    runVersionTests<RMQ>(  1000,   5000,   1000,   10,   1000,  10000, params);
+    runVersionTests<RMQ>(100000, 500000, 200000,    1,    100, 100000, params);
+    cout << "All tests completed!" << endl;
   }
   
-  /* Picks which test function to run. */
-  function<void (const TestParameters&)> selectTestFunction(const unordered_map<string, string>& args) {
-    if (!args.count("-rmq")) throw runtime_error("No RMQ type selected. Use the syntax ./run-tests -rmq ClassName to choose an RMQ type.");
+  /* Picks indices in [0, count) following a Zipfian distribution, where the
+   * k-th most popular index is chosen with probability proportional to
+   * 1 / (k + 1)^skew.
+   */
+  class ZipfianDistribution {
+  public:
+    ZipfianDistribution(size_t count, double skew) : cdf(count) {
+      double total = 0;
+      for (size_t k = 0; k < count; k++) {
+        total += 1.0 / pow(k + 1, skew);
+        cdf[k] = total;
+      }
+      for (double& value: cdf) value /= total;
+    }
     
-    string rmqType = toLowerCase(args.at("-rmq"));
+    template <typename URBG> size_t operator() (URBG& generator) {
+      double target = uniform_real_distribution<double>(0, 1)(generator);
+      return min<size_t>(lower_bound(cdf.begin(), cdf.end(), target) - cdf.begin(), cdf.size() - 1);
+    }
     
-    /* Strip off extensions. */
-    size_t dotIndex = rmqType.find('.');
-    if (dotIndex != string::npos) {
-      rmqType = rmqType.substr(0, dotIndex);
+  private:
+    vector<double> cdf;
+  };
+  
+  /* Compares answering a skewed stream of queries with and without a cache in
+   * front of the specified RMQ structure. Queries are drawn from a fixed pool
+   * of random ranges with Zipfian popularity, and the query stream is made up
+   * front so that drawing from the distribution isn't part of the timing.
+   */
+  template <typename RMQ> void runCacheTests(size_t numElems, size_t numRanges, size_t numQueries,
+                                             const vector<double>& skews,
+                                             const TestParameters& params) {
+    mt19937 generator(params.seed);
+    uniform_int_distribution<size_t> dist(0, numElems - 1);
+    
+    vector<RMQEntry> data(numElems);
+    for (size_t i = 0; i < numElems; i++) {
+      data[i] = RMQEntry(dist(generator));
     }
     
-    if (rmqType == "fastestrmq")     return &testRMQ<FastestRMQ>;
-    if (rmqType == "fischerheunrmq") return &testRMQ<FischerHeunRMQ>;
-    if (rmqType == "hybridrmq")      return &testRMQ<HybridRMQ>;
-    if (rmqType == "precomputedrmq") return &testRMQ<PrecomputedRMQ>;
-    if (rmqType == "sparsetablermq") return &testRMQ<SparseTableRMQ>;
-    if (rmqType == "segmenttreermq") return &testRMQ<SegmentTreeRMQ>;
+    vector<RMQQuery> ranges(numRanges);
+    for (auto& range: ranges) {
+      size_t low  = dist(generator);
+      size_t high = dist(generator);
+      if (low > high) swap(low, high);
+      range = { low, high + 1 };
+    }
     
-    throw runtime_error("Unrecognized RMQ type: " + args.at("-rmq") + ". (Check your spelling?)");
+    RMQ plain(data.data(), data.size());
+    CachedRMQ<RMQ> cached(data.data(), data.size());
+    vector<size_t> plainAnswers(numQueries), cachedAnswers(numQueries);
+    
+    for (double skew: skews) {
+      params.printer->startTest(numElems, 1, numQueries);
+      
+      ZipfianDistribution zipf(numRanges, skew);
+      vector<RMQQuery> queries(numQueries);
+      for (auto& query: queries) {
+        query = ranges[zipf(generator)];
+      }
+      
+      Timer plainTimer, cachedTimer;
+      plainTimer.start();
+      for (size_t i = 0; i < numQueries; i++) {
+        plainAnswers[i] = plain.rmq(queries[i].low, queries[i].high);
+      }
+      plainTimer.stop();
+      
+      cached.resetCounters();
+      cachedTimer.start();
+      for (size_t i = 0; i < numQueries; i++) {
+        cachedAnswers[i] = cached.rmq(queries[i].low, queries[i].high);
+      }
+      cachedTimer.stop();
+      
+      if (plainAnswers != cachedAnswers) {
+        cerr << "Error: cached query produced the wrong answer. " << endl;
+        abortProgram();
+      }
+      
+      double plainTime  = double(plainTimer.elapsed())  / numQueries;
+      double cachedTime = double(cachedTimer.elapsed()) / numQueries;
+      params.printer->reportMetric("Zipf skew", skew, "");
+      params.printer->reportMetric("Uncached time / query", plainTime, "ns");
+      params.printer->reportMetric("Cached time / query", cachedTime, "ns");
+      params.printer->reportMetric("Speedup", plainTime / cachedTime, "x");
+      params.printer->reportMetric("Hit rate", cached.hitRate(), "");
+      params.printer->endTest();
+    }
   }
   
-  /* Converts a string to a size_t. */
-  size_t stringToSizeT(const string& input) {
-    istringstream converter(input);
+  /* Tests a result cache in front of the specified RMQ structure. */
+  template <typename RMQ> void testCache(const TestParameters& params) {
+    /*                    elems  ranges  queries  skews */
+    runCacheTests<RMQ>( 100000, 100000, 2000000, { 0.5, 0.99, 1.2 }, params);
+    runCacheTests<RMQ>(1000000, 100000, 2000000, { 0.5, 0.99, 1.2 }, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* Finds the k smallest elements of [low, high) the straightforward way:
+   * keep a list of the pieces of the range that are left, and on each step
+   * query every piece to find which one holds the next smallest element.
+   */
+  template <typename RMQ> vector<size_t> naiveTopK(const RMQ& rmq, const vector<RMQEntry>& data,
+                                                   size_t low, size_t high, size_t k) {
+    vector<size_t> result;
+    vector<RMQQuery> pieces = { { low, high } };
     
-    size_t result;
-    char leftover;
-    if (!(converter >> result) || converter >> leftover) throw runtime_error("Could not parse \"" + input + "\" as a size_t.");
+    while (result.size() < k && !pieces.empty()) {
+      size_t bestPiece = 0, bestIndex = rmq.rmq(pieces[0].low, pieces[0].high);
+      for (size_t i = 1; i < pieces.size(); i++) {
+        size_t index = rmq.rmq(pieces[i].low, pieces[i].high);
+        if (data[index] < data[bestIndex]) {
+          bestPiece = i;
+          bestIndex = index;
+        }
+      }
+      
+      result.push_back(bestIndex);
+      RMQQuery piece = pieces[bestPiece];
+      pieces.erase(pieces.begin() + bestPiece);
+      if (piece.low < bestIndex)      pieces.push_back({ piece.low, bestIndex });
+      if (bestIndex + 1 < piece.high) pieces.push_back({ bestIndex + 1, piece.high });
+    }
     
     return result;
   }
   
-  /* Sets up the test arguments. */
-  TestParameters selectTestParameters(const unordered_map<string, string>& args) {
-    TestParameters result;
+  /* Compares finding the k smallest elements of random ranges using TopK
+   * against the naive approach, for several values of k. Both answers are
+   * checked against each other, and a sample is checked by sorting.
+   */
+  template <typename RMQ> void runTopKTests(size_t numElems, const vector<size_t>& ks,
+                                            size_t numSteps, const TestParameters& params) {
+    mt19937 generator(params.seed);
+    uniform_int_distribution<size_t> dist(0, numElems - 1);
     
-    /* Set the random seed. */
-    result.seed = args.count("-seed")? stringToSizeT(args.at("-seed")) : 0;
+    vector<RMQEntry> data(numElems);
+    for (auto& elem: data) {
+      elem = RMQEntry(dist(generator));
+    }
+    
+    RMQ rmq(data.data(), data.size());
+    TopK<RMQ> finder(rmq, data.data());
+    vector<size_t> scratch;
+    
+    for (size_t k: ks) {
+      /* Keep the total number of elements found about the same for each k. */
+      size_t numQueries = max<size_t>(10, numSteps / k);
+      params.printer->startTest(numElems, 1, numQueries);
+      
+      vector<RMQQuery> queries(numQueries);
+      for (auto& query: queries) {
+        size_t low  = dist(generator);
+        size_t high = dist(generator);
+        if (low > high) swap(low, high);
+        query = { low, high + 1 };
+      }
+      
+      /* Run each approach over the whole batch separately, so that neither
+       * one warms up the cache for the other.
+       */
+      Timer topKTimer, naiveTimer;
+      vector<vector<size_t>> ours(numQueries), theirs(numQueries);
+      for (auto& answer: ours) {
+        answer.reserve(k);
+      }
+      
+      topKTimer.start();
+      for (size_t i = 0; i < numQueries; i++) {
+        finder.topK(queries[i].low, queries[i].high, k, scratch);
+        ours[i].assign(scratch.begin(), scratch.end());
+      }
+      topKTimer.stop();
+      
+      naiveTimer.start();
+      for (size_t i = 0; i < numQueries; i++) {
+        theirs[i] = naiveTopK(rmq, data, queries[i].low, queries[i].high, k);
+      }
+      naiveTimer.stop();
+      
+      for (size_t i = 0; i < numQueries; i++) {
+        if (ours[i].size() != theirs[i].size()) {
+          cerr << "Error: top-k query found the wrong number of elements. " << endl;
+          abortProgram();
+        }
+        for (size_t j = 0; j < ours[i].size(); j++) {
+          if (data[ours[i][j]] != data[theirs[i][j]]) {
+            cerr << "Error: top-k query produced the wrong answer. " << endl;
+            abortProgram();
+          }
+        }
+        
+        if (i % max<size_t>(1, numQueries / 20) == 0) {
+          vector<RMQEntry> sorted(ours[i].size());
+          partial_sort_copy(data.begin() + queries[i].low, data.begin() + queries[i].high,
+                            sorted.begin(), sorted.end());
+          for (size_t j = 0; j < ours[i].size(); j++) {
+            if (data[ours[i][j]] != sorted[j]) {
+              cerr << "Error: top-k query produced the wrong answer. " << endl;
+              abortProgram();
+            }
+          }
+        }
+      }
+      
+      params.printer->reportMetric("k", k, "");
+      params.printer->reportMetric("TopK time / query", double(topKTimer.elapsed()) / numQueries, "ns");
+      params.printer->reportMetric("Naive time / query", double(naiveTimer.elapsed()) / numQueries, "ns");
+      params.printer->reportMetric("Speedup", double(naiveTimer.elapsed()) / topKTimer.elapsed(), "x");
+      params.printer->endTest();
+    }
+  }
+  
+  /* Tests finding the k smallest elements of a range with the specified RMQ
+   * structure.
+   */
+  template <typename RMQ> void testTopK(const TestParameters& params) {
+    /*                   elems  ks                           steps */
+    runTopKTests<RMQ>(1000000, { 1, 4, 16, 64, 256, 1024 },  100000, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* RMQ types that answer order statistic queries. */
+  template <typename RMQ> concept OrderStatistics = requires(const RMQ rmq, size_t index, RMQEntry value) {
+    { rmq.kth(index, index, index) } -> same_as<RMQEntry>;
+    { rmq.countBelow(index, index, value) } -> same_as<size_t>;
+  };
+  
+  /* Compares answering range k-th smallest and range counting queries against
+   * copying and sorting each range. The sorted copies double as the reference
+   * answers.
+   */
+  template <typename RMQ> void runKthTests(size_t min, size_t max, size_t step,
+                                           size_t numQueries, const TestParameters& params) {
+    mt19937 generator(params.seed);
+    
+    for (size_t numElems = min; numElems <= max; numElems *= step) {
+      params.printer->startTest(numElems, 1, numQueries);
+      
+      Timer buildTimer, kthTimer, countTimer, sortTimer;
+      uniform_int_distribution<size_t> dist(0, numElems - 1);
+      
+      vector<RMQEntry> data(numElems);
+      for (auto& elem: data) {
+        elem = RMQEntry(dist(generator));
+      }
+      
+      /* Each query gets a range, a rank, and a bound to count below. */
+      vector<RMQQuery> ranges(numQueries);
+      vector<size_t> ranks(numQueries);
+      vector<RMQEntry> bounds(numQueries);
+      for (size_t i = 0; i < numQueries; i++) {
+        size_t low  = dist(generator);
+        size_t high = dist(generator);
+        if (low > high) swap(low, high);
+        ranges[i] = { low, high + 1 };
+        ranks[i]  = uniform_int_distribution<size_t>(0, high - low)(generator);
+        bounds[i] = RMQEntry(dist(generator));
+      }
+      
+      buildTimer.start();
+      RMQ tested(data.data(), data.size());
+      buildTimer.stop();
+      
+      vector<RMQEntry> kths(numQueries);
+      kthTimer.start();
+      for (size_t i = 0; i < numQueries; i++) {
+        kths[i] = tested.kth(ranges[i].low, ranges[i].high, ranks[i]);
+      }
+      kthTimer.stop();
+      
+      vector<size_t> counts(numQueries);
+      countTimer.start();
+      for (size_t i = 0; i < numQueries; i++) {
+        counts[i] = tested.countBelow(ranges[i].low, ranges[i].high, bounds[i]);
+      }
+      countTimer.stop();
+      
+      for (size_t i = 0; i < numQueries; i++) {
+        sortTimer.start();
+        vector<RMQEntry> sorted(data.begin() + ranges[i].low, data.begin() + ranges[i].high);
+        sort(sorted.begin(), sorted.end());
+        sortTimer.stop();
+        
+        if (kths[i] != sorted[ranks[i]]) {
+          cerr << "Error: k-th smallest query produced the wrong answer. " << endl;
+          abortProgram();
+        }
+        if (counts[i] != size_t(lower_bound(sorted.begin(), sorted.end(), bounds[i]) - sorted.begin())) {
+          cerr << "Error: count query produced the wrong answer. " << endl;
+          abortProgram();
+        }
+      }
+      
+      params.printer->reportMetric("Build time", buildTimer.elapsed(), "ns");
+      params.printer->reportMetric("Kth time / query", double(kthTimer.elapsed()) / numQueries, "ns");
+      params.printer->reportMetric("Count below time / query", double(countTimer.elapsed()) / numQueries, "ns");
+      params.printer->reportMetric("Sort time / query", double(sortTimer.elapsed()) / numQueries, "ns");
+      params.printer->reportMetric("Speedup", double(sortTimer.elapsed()) / kthTimer.elapsed(), "x");
+      reportMemory(params, tested.memoryUsage(), numElems);
+      params.printer->endTest();
+    }
+  }
+  
+  /* Tests range order statistics with the specified structure. */
+  template <typename RMQ> void testKth(const TestParameters& params) {
+    /*                    min     max  step queries */
+    runKthTests<RMQ>(   1000,  100000,   10,   2000, params);
+    runKthTests<RMQ>(1000000, 1000000,   10,    100, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* RMQ types that can search for the first value below a threshold. */
+  template <typename RMQ> concept ThresholdSearchable = requires(const RMQ rmq, size_t index, RMQEntry value) {
+    { rmq.firstBelow(index, index, value) } -> same_as<size_t>;
+  };
+  
+  /* Finds the first value in [low, high) below the threshold by binary
+   * searching for the shortest prefix of the range whose minimum is below it.
+   */
+  template <typename RMQ> size_t bisectFirstBelow(const RMQ& rmq, const vector<RMQEntry>& data,
+                                                  size_t low, size_t high, RMQEntry threshold) {
+    if (!(data[rmq.rmq(low, high)] < threshold)) return high;
+    
+    /* Invariant: [low, end) has nothing below the threshold and [low, hit)
+     * has something.
+     */
+    size_t end = low, hit = high;
+    while (hit - end > 1) {
+      size_t mid = end + (hit - end) / 2;
+      if (data[rmq.rmq(low, mid)] < threshold) hit = mid;
+      else end = mid;
+    }
+    return end;
+  }
+  
+  /* Compares the native threshold search against bisecting with RMQs. The
+   * thresholds are picked so that each range holds only a few values below
+   * them on average, which puts the answer anywhere in the range and
+   * sometimes means there is no answer at all.
+   */
+  template <typename RMQ> void runThresholdTests(size_t min, size_t max, size_t step,
+                                                 size_t numQueries, const TestParameters& params) {
+    mt19937 generator(params.seed);
+    
+    for (size_t numElems = min; numElems <= max; numElems *= step) {
+      params.printer->startTest(numElems, 1, numQueries);
+      uniform_int_distribution<size_t> dist(0, numElems - 1);
+      
+      vector<RMQEntry> data(numElems);
+      for (auto& elem: data) {
+        elem = RMQEntry(dist(generator));
+      }
+      
+      vector<RMQQuery> ranges(numQueries);
+      vector<RMQEntry> thresholds(numQueries);
+      for (size_t i = 0; i < numQueries; i++) {
+        size_t low  = dist(generator);
+        size_t high = dist(generator);
+        if (low > high) swap(low, high);
+        ranges[i] = { low, high + 1 };
+        
+        size_t limit = 4 * numElems / (high + 1 - low);
+        thresholds[i] = RMQEntry(uniform_int_distribution<size_t>(0, limit)(generator));
+      }
+      
+      RMQ tested(data.data(), data.size());
+      vector<size_t> ours(numQueries), theirs(numQueries);
+      
+      auto bisectAll = [&] {
+        for (size_t i = 0; i < numQueries; i++) {
+          theirs[i] = bisectFirstBelow(tested, data, ranges[i].low, ranges[i].high, thresholds[i]);
+        }
+      };
+      auto nativeAll = [&] {
+        for (size_t i = 0; i < numQueries; i++) {
+          ours[i] = tested.firstBelow(ranges[i].low, ranges[i].high, thresholds[i]);
+        }
+      };
+      
+      /* Both approaches read the same array and structure, so whichever runs
+       * first would pay for bringing them into cache. An untimed pass of each
+       * beforehand puts the timed passes on an equal footing.
+       */
+      bisectAll();
+      nativeAll();
+      
+      Timer nativeTimer, bisectTimer;
+      bisectTimer.start();
+      bisectAll();
+      bisectTimer.stop();
+      
+      nativeTimer.start();
+      nativeAll();
+      nativeTimer.stop();
+      
+      /* Check a sample by scanning, and everything against bisection. */
+      size_t found = 0;
+      for (size_t i = 0; i < numQueries; i++) {
+        if (ours[i] != theirs[i]) {
+          cerr << "Error: threshold search produced the wrong answer. " << endl;
+          abortProgram();
+        }
+        if (i % 1000 == 0) {
+          size_t expected = ranges[i].low;
+          while (expected < ranges[i].high && !(data[expected] < thresholds[i])) expected++;
+          if (ours[i] != expected) {
+            cerr << "Error: threshold search produced the wrong answer. " << endl;
+            abortProgram();
+          }
+        }
+        if (ours[i] != ranges[i].high) found++;
+      }
+      
+      params.printer->reportMetric("Native time / query", double(nativeTimer.elapsed()) / numQueries, "ns");
+      params.printer->reportMetric("Bisection time / query", double(bisectTimer.elapsed()) / numQueries, "ns");
+      params.printer->reportMetric("Speedup", double(bisectTimer.elapsed()) / nativeTimer.elapsed(), "x");
+      params.printer->reportMetric("Fraction found", double(found) / numQueries, "");
+      params.printer->endTest();
+    }
+  }
+  
+  /* Tests searching for the first value below a threshold. */
+  template <typename RMQ> void testThreshold(const TestParameters& params) {
+    /*                      min      max  step  queries */
+    runThresholdTests<RMQ>(1000, 1000000,   10,  200000, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* Tests LCA queries on large trees using the specified RMQ structure. A tree
+   * with n nodes has an Euler tour of 2n - 1 steps, so types with a size limit
+   * get smaller trees whose tours fit within it instead.
+   */
+  template <typename RMQ> void testLCA(const TestParameters& params) {
+    if constexpr (kMaxElems<RMQ> >= 2 * 10000000 - 1) {
+      /*                   min       max      step builds  queries */
+      runLCATests<RMQ>(1000000, 10000000, 3000000,     1, 1000000, params);
+    } else {
+      constexpr size_t kMaxNodes = (kMaxElems<RMQ> + 1) / 2;
+      runLCATests<RMQ>(kMaxNodes / 5, kMaxNodes, kMaxNodes / 5, 1, 1000000, params);
+    }
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* Makes a random text over a small alphabet, with chunks of earlier text
+   * copied forward so that there are some long repeats to find.
+   */
+  string makeRandomText(size_t length, mt19937& generator) {
+    uniform_int_distribution<int>    letter(0, 3);
+    uniform_int_distribution<int>    coin(0, 9);
+    uniform_int_distribution<size_t> chunkLength(1, 1000);
+    
+    string result;
+    result.reserve(length);
+    while (result.size() < length) {
+      if (result.size() > 1000 && coin(generator) == 0) {
+        size_t chunk = min(chunkLength(generator), length - result.size());
+        size_t start = uniform_int_distribution<size_t>(0, result.size() - chunk)(generator);
+        for (size_t i = 0; i < chunk; i++) {
+          result += result[start + i];
+        }
+      } else {
+        result += "ACGT"[letter(generator)];
+      }
+    }
+    return result;
+  }
+  
+  /* Tests and reports timing information about answering longest common
+   * extension queries on random texts using the specified RMQ structure.
+   */
+  template <typename RMQ> void runLCETests(size_t min, size_t max, size_t step,
+                                           size_t numBuilds, size_t numQueries,
+                                           const TestParameters& params) {
+    mt19937 generator(params.seed);
+    
+    for (size_t length = min; length <= max; length += step) {
+      params.printer->startTest(length, numBuilds, numQueries);
+      
+      Timer buildTimer, queryTimer;
+      size_t memory = 0;
+      uniform_int_distribution<size_t> dist(0, length - 1);
+      
+      for (size_t build = 0; build < numBuilds; build++) {
+        string text = makeRandomText(length, generator);
+        
+        buildTimer.start();
+        LCE<RMQ> tested(text);
+        buildTimer.stop();
+        memory = tested.memoryUsage();
+        
+        for (size_t query = 0; query < numQueries; query++) {
+          size_t i = dist(generator);
+          size_t j = dist(generator);
+          
+          queryTimer.start();
+          size_t theirs = tested.lce(i, j);
+          queryTimer.stop();
+          
+          /* Check the answer directly against the text. */
+          size_t ours = 0;
+          while (std::max(i, j) + ours < length && text[i + ours] == text[j + ours]) {
+            ours++;
+          }
+          
+          if (ours != theirs) {
+            cerr << "Error: LCE query produced the wrong answer. " << endl;
+            abortProgram();
+          }
+        }
+      }
+      
+      size_t buildTime = buildTimer.elapsed() / numBuilds;
+      params.printer->reportResult(buildTime, queryTimer.elapsed() / (numQueries * numBuilds));
+      params.printer->reportMetric("Build throughput", length * 1000.0 / buildTime, "MB/s");
+      reportMemory(params, memory, length);
+      params.printer->endTest();
+    }
+  }
+  
+  /* Tests LCE queries on multi-megabyte texts using the specified RMQ structure. */
+  template <typename RMQ> void testLCE(const TestParameters& params) {
+    /*                   min      max     step builds  queries */
+    runLCETests<RMQ>(1000000, 7000000, 2000000,     1, 1000000, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* Compares answering batches of queries offline against building a sparse
+   * table and querying it.
+   */
+  void runOfflineTests(size_t min, size_t max, size_t step,
+                       size_t numBuilds, size_t numQueries,
+                       const TestParameters& params) {
+    mt19937 generator(params.seed);
+    
+    for (size_t numElems = min; numElems <= max; numElems += step) {
+      params.printer->startTest(numElems, numBuilds, numQueries);
+    
+      Timer offlineTimer, sparseTimer;
+      uniform_int_distribution<size_t> dist(0, numElems - 1);
+      
+      vector<RMQEntry> data(numElems);
+      vector<RMQQuery> queries(numQueries);
+      
+      for (size_t build = 0; build < numBuilds; build++) {
+        for (size_t i = 0; i < numElems; i++) {
+          data[i] = RMQEntry(dist(generator));
+        }
+        
+        for (auto& query: queries) {
+          size_t low  = dist(generator);
+          size_t high = dist(generator);
+          if (low > high) swap(low, high);
+          query = { low, high + 1 };
+        }
+        
+        /* Answer everything in one batch. */
+        offlineTimer.start();
+        vector<size_t> offline = offlineRMQ(data.data(), data.size(), queries);
+        offlineTimer.stop();
+        
+        /* Answer everything with a freshly-built sparse table. */
+        sparseTimer.start();
+        {
+          SparseTableRMQ sparse(data.data(), data.size());
+          for (const auto& query: queries) {
+            sparse.rmq(query.low, query.high);
+          }
+        }
+        sparseTimer.stop();
+        
+        /* Confirm that the offline answers are right. */
+        SegmentTreeRMQ answer(data.data(), data.size());
+        for (size_t i = 0; i < numQueries; i++) {
+          if (offline[i] >= numElems) {
+            cerr << "Error: query produced an answer that was out of bounds." << endl;
+            abortProgram();
+          }
+          if (data[offline[i]] != data[answer.rmq(queries[i].low, queries[i].high)]) {
+            cerr << "Error: query produced the wrong answer. " << endl;
+            abortProgram();
+          }
+        }
+      }
+      
+      size_t totalQueries = numQueries * numBuilds;
+      params.printer->reportMetric("Offline time / query", offlineTimer.elapsed() / totalQueries, "ns");
+      params.printer->reportMetric("SparseTableRMQ build + query time / query", sparseTimer.elapsed() / totalQueries, "ns");
+      params.printer->endTest();
+    }
+  }
+  
+  /* Tests the offline RMQ solver. */
+  void testOfflineRMQ(const TestParameters& params) {
+    /*                min     max     step  builds queries */
+    runOfflineTests(  1000,   5000,   1000,  1000,   10000, params);
+    runOfflineTests(100000, 500000, 100000,     5, 1000000, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* Writes an array out as a flat file of 32-bit integers, then asks the
+   * kernel to drop it from the page cache so that reading it back actually
+   * goes to disk.
+   */
+  void writeArrayFile(const string& filename, const vector<RMQEntry>& data) {
+    {
+      ofstream output(filename, ios::binary);
+      output.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(RMQEntry));
+      if (!output) throw runtime_error("Couldn't write " + filename + ".");
+    }
+    
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd >= 0) {
+      fdatasync(fd);
+      posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      close(fd);
+    }
+  }
+  
+  /* Tests and reports timing information about the out-of-core RMQ structure
+   * on freshly generated files. Checking every answer by brute force would
+   * take far longer than the test itself, so only a sample of the queries is
+   * checked.
+   */
+  void runExternalTests(const vector<size_t>& sizes, size_t numQueries, size_t numChecked,
+                        const TestParameters& params) {
+    mt19937 generator(params.seed);
+    TempFile file((filesystem::temp_directory_path() / ("rmq-external-" + to_string(getpid()) + ".bin")).string());
+    const string& filename = file.name();
+    
+    for (size_t numElems: sizes) {
+      params.printer->startTest(numElems, 1, numQueries);
+      
+      Timer buildTimer, queryTimer;
+      uniform_int_distribution<size_t> dist(0, numElems - 1);
+      
+      vector<RMQEntry> data(numElems);
+      for (size_t i = 0; i < numElems; i++) {
+        data[i] = RMQEntry(dist(generator));
+      }
+      writeArrayFile(filename, data);
+      
+      vector<RMQQuery> queries(numQueries);
+      for (auto& query: queries) {
+        size_t low  = dist(generator);
+        size_t high = dist(generator);
+        if (low > high) swap(low, high);
+        query = { low, high + 1 };
+      }
+      vector<size_t> answers(numQueries);
+      
+      buildTimer.start();
+      ExternalRMQ tested(filename);
+      buildTimer.stop();
+      
+      queryTimer.start();
+      for (size_t i = 0; i < numQueries; i++) {
+        answers[i] = tested.rmq(queries[i].low, queries[i].high);
+      }
+      queryTimer.stop();
+      
+      /* Check an evenly spaced sample of the answers against a segment tree.
+       * One over the whole array would need far more memory than anything else
+       * here, so the reference is built over one chunk of the array at a time,
+       * and each checked query keeps the smallest of its pieces' answers. The
+       * chunks go left to right, so ties keep the leftmost.
+       */
+      const size_t kChunkSize = size_t(1) << 24;
+      vector<size_t> checked;
+      for (size_t i = 0; i < numQueries; i += max<size_t>(1, numQueries / numChecked)) {
+        checked.push_back(i);
+      }
+      vector<size_t> expected(checked.size(), numElems);
+      for (size_t chunk = 0; chunk < numElems; chunk += kChunkSize) {
+        size_t chunkEnd = min(numElems, chunk + kChunkSize);
+        SegmentTreeRMQ answer(data.data() + chunk, chunkEnd - chunk);
+        
+        for (size_t j = 0; j < checked.size(); j++) {
+          size_t low  = max(queries[checked[j]].low,  chunk);
+          size_t high = min(queries[checked[j]].high, chunkEnd);
+          if (low >= high) continue;
+          
+          size_t index = chunk + answer.rmq(low - chunk, high - chunk);
+          if (expected[j] == numElems || data[index] < data[expected[j]]) expected[j] = index;
+        }
+      }
+      
+      for (size_t j = 0; j < checked.size(); j++) {
+        size_t i = checked[j];
+        if (answers[i] >= numElems) {
+          cerr << "Error: query produced an answer that was out of bounds." << endl;
+          abortProgram();
+        }
+        if (data[answers[i]] != data[expected[j]]) {
+          cerr << "Error: query produced the wrong answer. " << endl;
+          abortProgram();
+        }
+      }
+      
+      size_t buildTime = buildTimer.elapsed();
+      params.printer->reportResult(buildTime, queryTimer.elapsed() / numQueries);
+      params.printer->reportMetric("Build throughput", numElems * sizeof(RMQEntry) * 1000.0 / buildTime, "MB/s");
+      params.printer->reportMetric("Block reads / query", double(tested.blockReads()) / numQueries, "");
+      reportMemory(params, tested.memoryUsage(), numElems);
+      params.printer->endTest();
+    }
+  }
+  
+  /* Tests the out-of-core RMQ structure. */
+  void testExternalRMQ(const TestParameters& params) {
+    runExternalTests({ 1000000, 16000000, 64000000 }, 100000, 1000, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* Tests and reports timing information about a two-dimensional RMQ
+   * structure on square grids of the given sizes. Checking a query by brute
+   * force means scanning a big chunk of the grid, so only an evenly spaced
+   * sample of the queries is checked.
+   */
+  template <typename RMQ> void runGridTests(const vector<size_t>& sides, size_t numQueries,
+                                            size_t numChecked, const TestParameters& params) {
+    mt19937 generator(params.seed);
+    
+    for (size_t side: sides) {
+      size_t numElems = side * side;
+      params.printer->startTest(numElems, 1, numQueries);
+      
+      Timer buildTimer, queryTimer;
+      uniform_int_distribution<size_t> valueDist(0, numElems - 1);
+      uniform_int_distribution<size_t> sideDist(0, side - 1);
+      
+      vector<RMQEntry> grid(numElems);
+      for (auto& cell: grid) {
+        cell = RMQEntry(valueDist(generator));
+      }
+      
+      /* Pick rectangles as pairs of row ranges and column ranges. */
+      vector<RMQQuery> rowRanges(numQueries), colRanges(numQueries);
+      for (size_t i = 0; i < numQueries; i++) {
+        for (RMQQuery* range: { &rowRanges[i], &colRanges[i] }) {
+          size_t low  = sideDist(generator);
+          size_t high = sideDist(generator);
+          if (low > high) swap(low, high);
+          *range = { low, high + 1 };
+        }
+      }
+      vector<GridPosition> answers(numQueries);
+      
+      buildTimer.start();
+      RMQ tested(grid.data(), side, side);
+      buildTimer.stop();
+      
+      queryTimer.start();
+      for (size_t i = 0; i < numQueries; i++) {
+        answers[i] = tested.rmq(rowRanges[i].low, rowRanges[i].high, colRanges[i].low, colRanges[i].high);
+      }
+      queryTimer.stop();
+      
+      for (size_t i = 0; i < numQueries; i += max<size_t>(1, numQueries / numChecked)) {
+        const auto& rows = rowRanges[i];
+        const auto& cols = colRanges[i];
+        if (answers[i].row < rows.low || answers[i].row >= rows.high ||
+            answers[i].col < cols.low || answers[i].col >= cols.high) {
+          cerr << "Error: query produced an answer that was out of bounds." << endl;
+          abortProgram();
+        }
+        
+        RMQEntry smallest = grid[rows.low * side + cols.low];
+        for (size_t r = rows.low; r < rows.high; r++) {
+          smallest = min(smallest, *min_element(&grid[r * side + cols.low], &grid[r * side + cols.high]));
+        }
+        if (grid[answers[i].row * side + answers[i].col] != smallest) {
+          cerr << "Error: query produced the wrong answer. " << endl;
+          abortProgram();
+        }
+      }
+      
+      params.printer->reportMetric("Grid side", side, "");
+      params.printer->reportResult(buildTimer.elapsed(), queryTimer.elapsed() / numQueries);
+      reportMemory(params, tested.memoryUsage(), numElems);
+      params.printer->endTest();
+    }
+  }
+  
+  /* Tests a two-dimensional RMQ structure on grids of up to MaxSide x MaxSide
+   * elements. The limit keeps structures with superlinear space within reach
+   * of an ordinary machine's memory.
+   */
+  template <typename RMQ, size_t MaxSide> void testGrid(const TestParameters& params) {
+    vector<size_t> sides;
+    for (size_t side: { 16, 64, 256, 1024, 2048, 4096 }) {
+      if (side <= MaxSide) sides.push_back(side);
+    }
+    runGridTests<RMQ>(sides, 100000, 200, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* Compares answering the same ranges over several parallel columns using
+   * one MultiColumnRMQ against using a separate SparseTableRMQ per column. Each
+   * approach runs over the whole batch of queries separately, after an untimed
+   * pass of both, and every answer is checked against the other approach's.
+   * Combinations with more than maxCells elements in total are skipped to keep
+   * the tables within memory.
+   */
+  void runMultiColumnTests(const vector<size_t>& sizes, const vector<size_t>& widths,
+                           size_t numQueries, size_t maxCells, const TestParameters& params) {
+    mt19937 generator(params.seed);
+    
+    for (size_t numElems: sizes) {
+      for (size_t numColumns: widths) {
+        if (numElems * numColumns > maxCells) continue;
+        params.printer->startTest(numElems, 1, numQueries);
+        
+        Timer buildTimer, queryTimer, separateTimer;
+        uniform_int_distribution<size_t> dist(0, numElems - 1);
+        
+        vector<vector<RMQEntry>> data(numColumns, vector<RMQEntry>(numElems));
+        vector<const RMQEntry*> columns;
+        for (auto& column: data) {
+          for (auto& elem: column) {
+            elem = RMQEntry(dist(generator));
+          }
+          columns.push_back(column.data());
+        }
+        
+        vector<RMQQuery> queries(numQueries);
+        for (auto& query: queries) {
+          size_t low  = dist(generator);
+          size_t high = dist(generator);
+          if (low > high) swap(low, high);
+          query = { low, high + 1 };
+        }
+        
+        buildTimer.start();
+        MultiColumnRMQ tested(columns.data(), numColumns, numElems);
+        buildTimer.stop();
+        
+        vector<unique_ptr<SparseTableRMQ>> separate;
+        size_t separateMemory = 0;
+        for (const auto& column: data) {
+          separate.push_back(make_unique<SparseTableRMQ>(column.data(), column.size()));
+          separateMemory += separate.back()->memoryUsage();
+        }
+        
+        vector<size_t> ours(numQueries * numColumns), theirs(numQueries * numColumns);
+        
+        auto separateAll = [&] {
+          for (size_t i = 0; i < numQueries; i++) {
+            for (size_t c = 0; c < numColumns; c++) {
+              theirs[i * numColumns + c] = separate[c]->rmq(queries[i].low, queries[i].high);
+            }
+          }
+        };
+        auto combinedAll = [&] {
+          for (size_t i = 0; i < numQueries; i++) {
+            tested.rmq(queries[i].low, queries[i].high, &ours[i * numColumns]);
+          }
+        };
+        
+        /* Without these, the separate tables would go first and pay alone for
+         * bringing the columns and the queries into cache.
+         */
+        separateAll();
+        combinedAll();
+        
+        separateTimer.start();
+        separateAll();
+        separateTimer.stop();
+        
+        queryTimer.start();
+        combinedAll();
+        queryTimer.stop();
+        
+        for (size_t i = 0; i < numQueries; i++) {
+          for (size_t c = 0; c < numColumns; c++) {
+            size_t index = ours[i * numColumns + c];
+            if (index < queries[i].low || index >= queries[i].high) {
+              cerr << "Error: query produced an answer that was out of bounds." << endl;
+              abortProgram();
+            }
+            if (data[c][index] != data[c][theirs[i * numColumns + c]]) {
+              cerr << "Error: query produced the wrong answer. " << endl;
+              abortProgram();
+            }
+            
+            /* The answer has to be the leftmost copy, so everything before it
+             * in the range must be strictly larger.
+             */
+            size_t low = queries[i].low;
+            if (index > low && !(data[c][index] < data[c][separate[c]->rmq(low, index)])) {
+              cerr << "Error: query didn't return the leftmost minimum." << endl;
+              abortProgram();
+            }
+          }
+        }
+        
+        params.printer->reportMetric("Columns", numColumns, "");
+        params.printer->reportResult(buildTimer.elapsed(), queryTimer.elapsed() / numQueries);
+        params.printer->reportMetric("Time / column", double(queryTimer.elapsed()) / (numQueries * numColumns), "ns");
+        params.printer->reportMetric("Separate time / column", double(separateTimer.elapsed()) / (numQueries * numColumns), "ns");
+        params.printer->reportMetric("Speedup", double(separateTimer.elapsed()) / queryTimer.elapsed(), "x");
+        params.printer->reportMetric("Separate memory usage", separateMemory, "bytes");
+        reportMemory(params, tested.memoryUsage(), numElems * numColumns);
+        params.printer->endTest();
+      }
+    }
+  }
+  
+  /* Tests the multi-column RMQ structure over a range of column counts. */
+  void testMultiColumnRMQ(const TestParameters& params) {
+    /*                   sizes                     columns             queries   max cells */
+    runMultiColumnTests({ 1000, 10000, 100000 }, { 1, 4, 16, 64 },  100000,   2000000, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* Compares finding both the minimum and the maximum of random ranges with
+   * one combined structure against using two copies of the corresponding RMQ
+   * type, one over the array and one over its negation. Each approach gets an
+   * untimed pass before the timed ones, and every answer is checked against
+   * the two copies'.
+   */
+  template <typename MinMaxRMQ, typename RMQ>
+  void runMinMaxTests(size_t min, size_t max, size_t step,
+                      size_t numQueries, const TestParameters& params) {
+    mt19937 generator(params.seed);
+    
+    for (size_t numElems = min; numElems <= max; numElems *= step) {
+      params.printer->startTest(numElems, 1, numQueries);
+      
+      Timer buildTimer, queryTimer, separateTimer;
+      uniform_int_distribution<size_t> dist(0, numElems - 1);
+      
+      vector<RMQEntry> data(numElems), negated(numElems);
+      for (size_t i = 0; i < numElems; i++) {
+        data[i]    = RMQEntry(dist(generator));
+        negated[i] = RMQEntry(-data[i].value());
+      }
+      
+      vector<RMQQuery> queries(numQueries);
+      for (auto& query: queries) {
+        size_t low  = dist(generator);
+        size_t high = dist(generator);
+        if (low > high) swap(low, high);
+        query = { low, high + 1 };
+      }
+      
+      buildTimer.start();
+      MinMaxRMQ tested(data.data(), data.size());
+      buildTimer.stop();
+      
+      RMQ minRMQ(data.data(), data.size());
+      RMQ maxRMQ(negated.data(), negated.size());
+      
+      vector<MinMaxPosition> ours(numQueries), theirs(numQueries);
+      
+      auto separateAll = [&] {
+        for (size_t i = 0; i < numQueries; i++) {
+          theirs[i] = { minRMQ.rmq(queries[i].low, queries[i].high),
+                        maxRMQ.rmq(queries[i].low, queries[i].high) };
+        }
+      };
+      auto combinedAll = [&] {
+        for (size_t i = 0; i < numQueries; i++) {
+          ours[i] = tested.rmq(queries[i].low, queries[i].high);
+        }
+      };
+      
+      /* Without these, the separate copies would go first and pay alone for
+       * bringing the array and the queries into cache.
+       */
+      separateAll();
+      combinedAll();
+      
+      separateTimer.start();
+      separateAll();
+      separateTimer.stop();
+      
+      queryTimer.start();
+      combinedAll();
+      queryTimer.stop();
+      
+      for (size_t i = 0; i < numQueries; i++) {
+        for (size_t index: { ours[i].min, ours[i].max }) {
+          if (index < queries[i].low || index >= queries[i].high) {
+            cerr << "Error: query produced an answer that was out of bounds." << endl;
+            abortProgram();
+          }
+        }
+        if (data[ours[i].min] != data[theirs[i].min] || data[ours[i].max] != data[theirs[i].max]) {
+          cerr << "Error: query produced the wrong answer. " << endl;
+          abortProgram();
+        }
+        
+        /* Both answers have to be the leftmost copies, so everything before
+         * them in the range must be strictly larger (or smaller). Asking the
+         * separate structures about that prefix checks this without relying
+         * on how they break ties.
+         */
+        size_t low = queries[i].low;
+        if ((ours[i].min > low && !(data[ours[i].min] < data[minRMQ.rmq(low, ours[i].min)])) ||
+            (ours[i].max > low && !(negated[ours[i].max] < negated[maxRMQ.rmq(low, ours[i].max)]))) {
+          cerr << "Error: query didn't return the leftmost minimum and maximum." << endl;
+          abortProgram();
+        }
+      }
+      
+      params.printer->reportResult(buildTimer.elapsed(), queryTimer.elapsed() / numQueries);
+      params.printer->reportMetric("Separate time / query", double(separateTimer.elapsed()) / numQueries, "ns");
+      params.printer->reportMetric("Speedup", double(separateTimer.elapsed()) / queryTimer.elapsed(), "x");
+      params.printer->reportMetric("Separate memory usage", minRMQ.memoryUsage() + maxRMQ.memoryUsage(), "bytes");
+      reportMemory(params, tested.memoryUsage(), numElems);
+      params.printer->endTest();
+    }
+  }
+  
+  /* Tests a combined min/max structure against two of the given RMQ type. */
+  template <typename MinMaxRMQ, typename RMQ> void testMinMax(const TestParameters& params) {
+    /*                             min      max  step  queries */
+    runMinMaxTests<MinMaxRMQ, RMQ>(1000, 1000000,  10,  200000, params);
+    cout << "All tests completed!" << endl;
+  }
+  
+  /* Tests a fixed-capacity RMQ structure, which only supports the tiny sizes. */
+  template <typename RMQ> void testTinyRMQ(const TestParameters& params) {
+    /*             min              max  step  builds queries */
+    runTests<RMQ>(  1,              25,    1, 10000,    100, params);
+    runTests<RMQ>( 32, RMQ::kCapacity,   32, 10000,    100, params);
+    cout << "All tests completed!" << endl;
+  }
+
+  /* Summary of the timings of one RMQ type at one size across several trials. */
+  struct BenchmarkResult {
+    string engine;
+    size_t numElems;
+    size_t trials;
+    double buildMedian, buildVariance; // Per build, in ns
+    double queryMedian, queryVariance; // Per query, in ns
+    size_t memory;                     // Bytes used by the last structure built
+    bool   correct;                    // Whether every answer checked out
+  };
+  
+  /* Returns the median and sample variance of a list of measurements. */
+  pair<double, double> medianAndVariance(vector<double> samples) {
+    sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    double median = n % 2 == 1? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    
+    double mean = accumulate(samples.begin(), samples.end(), 0.0) / n;
+    double variance = 0;
+    for (double sample: samples) {
+      variance += (sample - mean) * (sample - mean);
+    }
+    return { median, n > 1? variance / (n - 1) : 0.0 };
+  }
+  
+  /* Times the specified RMQ structure at one size over several trials. Each
+   * trial uses its own data set, but every RMQ type sees the same data sets so
+   * that they can be compared fairly. Wrong answers are recorded rather than
+   * aborting, so that one broken structure doesn't stop the whole suite.
+   */
+  template <typename RMQ> BenchmarkResult benchmarkRMQ(const string& name, size_t numElems,
+                                                       const TestParameters& params) {
+    BenchmarkResult result = { name, numElems, params.benchmarkTrials, 0, 0, 0, 0, 0, true };
+    vector<double> buildSamples, querySamples;
+    vector<RMQEntry> data(numElems);
+    
+    for (size_t trial = 0; trial < params.benchmarkTrials; trial++) {
+      mt19937 generator(params.seed + trial);
+      uniform_int_distribution<size_t> dist(0, numElems - 1);
+      Timer buildTimer, queryTimer;
+      
+      for (size_t build = 0; build < params.benchmarkBuilds; build++) {
+        for (size_t i = 0; i < numElems; i++) {
+          data[i] = RMQEntry(dist(generator));
+        }
+        
+        SegmentTreeRMQ answer(data.data(), data.size());
+        
+        buildTimer.start();
+        RMQ tested(data.data(), data.size());
+        buildTimer.stop();
+        result.memory = tested.memoryUsage();
+        
+        for (size_t query = 0; query < params.benchmarkQueries; query++) {
+          size_t low  = dist(generator);
+          size_t high = dist(generator);
+          if (low > high) swap(low, high);
+          high++;
+          
+          queryTimer.start();
+          size_t theirs = tested.rmq(low, high);
+          queryTimer.stop();
+          
+          if (theirs >= numElems || data[theirs] != data[answer.rmq(low, high)]) {
+            result.correct = false;
+          }
+        }
+      }
+      
+      buildSamples.push_back(double(buildTimer.elapsed()) / params.benchmarkBuilds);
+      querySamples.push_back(double(queryTimer.elapsed()) / (params.benchmarkBuilds * params.benchmarkQueries));
+    }
+    
+    tie(result.buildMedian, result.buildVariance) = medianAndVariance(buildSamples);
+    tie(result.queryMedian, result.queryVariance) = medianAndVariance(querySamples);
+    return result;
+  }
+  
+  /* An RMQ type the benchmark knows how to run. Some types can't handle every
+   * size (either by design or because they'd run out of memory), so each one
+   * lists the largest size it should be run on.
+   */
+  struct BenchmarkEngine {
+    string name;
+    BenchmarkResult (*run)(const string& name, size_t numElems, const TestParameters& params);
+    size_t maxElems;
+  };
+  
+  const vector<BenchmarkEngine> kBenchmarkEngines = {
+    /* FastestRMQ is left out while it's still the stub that answers every
+     * query with 0, since it would make every run report a wrong answer. Add
+     * it here once it's implemented.
+     */
+    { "FischerHeunRMQ", &benchmarkRMQ<FischerHeunRMQ>, kNoSizeLimit },
+    { "LazyFischerHeunRMQ", &benchmarkRMQ<LazyFischerHeunRMQ>, kNoSizeLimit },
+    { "HybridRMQ",      &benchmarkRMQ<HybridRMQ>,      kNoSizeLimit },
+    { "LazySegmentTreeRMQ", &benchmarkRMQ<LazySegmentTreeRMQ>, kNoSizeLimit },
+    { "PersistentSegmentTreeRMQ", &benchmarkRMQ<PersistentSegmentTreeRMQ>, kNoSizeLimit },
+    { "PrecomputedRMQ", &benchmarkRMQ<PrecomputedRMQ>, kMaxElems<PrecomputedRMQ> },
+    { "SegmentTreeRMQ", &benchmarkRMQ<SegmentTreeRMQ>, kNoSizeLimit },
+    { "SparseTableRMQ", &benchmarkRMQ<SparseTableRMQ>, kNoSizeLimit },
+    { "TinyRMQ",        &benchmarkRMQ<TinyRMQ<64>>,    TinyRMQ<64>::kCapacity },
+    { "WaveletMatrixRMQ", &benchmarkRMQ<WaveletMatrixRMQ>, kNoSizeLimit },
+  };
+  
+  /* Writes benchmark results out as JSON, one result per line. */
+  void writeBenchmarkJSON(ostream& out, const vector<BenchmarkResult>& results, const TestParameters& params) {
+    auto oldPrecision = out.precision(10);
+    out << "{" << endl;
+    out << "  \"seed\": " << params.seed << "," << endl;
+    out << "  \"hugePages\": " << (params.hugePages? "true" : "false") << "," << endl;
+    out << "  \"builds\": " << params.benchmarkBuilds << "," << endl;
+    out << "  \"queries\": " << params.benchmarkQueries << "," << endl;
+    out << "  \"results\": [" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+      const auto& result = results[i];
+      out << "    { \"engine\": \"" << result.engine << "\""
+          << ", \"elements\": " << result.numElems
+          << ", \"trials\": " << result.trials
+          << ", \"buildMedianNs\": " << result.buildMedian
+          << ", \"buildVariance\": " << result.buildVariance
+          << ", \"queryMedianNs\": " << result.queryMedian
+          << ", \"queryVariance\": " << result.queryVariance
+          << ", \"memoryBytes\": " << result.memory
+          << ", \"correct\": " << (result.correct? "true" : "false")
+          << " }" << (i + 1 == results.size()? "" : ",") << endl;
+    }
+    out << "  ]" << endl;
+    out << "}" << endl;
+    out.precision(oldPrecision);
+  }
+  
+  /* Pulls the value of a field out of one line of benchmark JSON. This only
+   * understands the format written by writeBenchmarkJSON, which is all we need
+   * for reading back a baseline.
+   */
+  string jsonField(const string& line, const string& key) {
+    size_t start = line.find("\"" + key + "\":");
+    if (start == string::npos) throw runtime_error("Baseline entry is missing field " + key + ".");
+    start = line.find_first_not_of(" \"", start + key.size() + 3);
+    
+    size_t end = line.find_first_of(",\"}", start);
+    return line.substr(start, end - start);
+  }
+  
+  /* Reads back results previously written by writeBenchmarkJSON. */
+  vector<BenchmarkResult> readBenchmarkJSON(const string& filename) {
+    ifstream input(filename);
+    if (!input) throw runtime_error("Could not open baseline file " + filename + ".");
+    
+    vector<BenchmarkResult> result;
+    for (string line; getline(input, line); ) {
+      if (line.find("\"engine\":") == string::npos) continue;
+      
+      result.push_back({
+        jsonField(line, "engine"),
+        stoul(jsonField(line, "elements")),
+        stoul(jsonField(line, "trials")),
+        stod(jsonField(line, "buildMedianNs")),
+        stod(jsonField(line, "buildVariance")),
+        stod(jsonField(line, "queryMedianNs")),
+        stod(jsonField(line, "queryVariance")),
+        stoul(jsonField(line, "memoryBytes")),
+        jsonField(line, "correct") == "true"
+      });
+    }
+    return result;
+  }
+  
+  /* Classifies the change in one timing against the baseline. A change only
+   * counts if it's more than three standard errors away from the baseline
+   * (so it's statistically significant) and more than 5% (so it matters).
+   */
+  string classifyChange(double current, double currentVariance, size_t currentTrials,
+                        double baseline, double baselineVariance, size_t baselineTrials) {
+    double standardError = sqrt(currentVariance / currentTrials + baselineVariance / baselineTrials);
+    double difference = current - baseline;
+    
+    if (fabs(difference) <= 3 * standardError || fabs(difference) <= 0.05 * baseline) return "";
+    return difference > 0? "REGRESSION" : "speedup";
+  }
+  
+  /* Classifies the change in memory use against the baseline. Memory doesn't
+   * vary from trial to trial the way timings do, but it still moves a little
+   * with allocator rounding and with how much lazily built structures fill in
+   * during the queries, so a change only counts if it's more than 1% and more
+   * than a page.
+   */
+  string classifyMemoryChange(double current, double baseline) {
+    double difference = current - baseline;
+    
+    if (fabs(difference) <= 0.01 * baseline || fabs(difference) <= 4096) return "";
+    return difference > 0? "REGRESSION" : "smaller";
+  }
+  
+  /* Compares results against a baseline, printing a report. Returns how many
+   * regressions were found.
+   */
+  size_t compareToBaseline(const vector<BenchmarkResult>& results, const vector<BenchmarkResult>& baseline) {
+    size_t regressions = 0;
+    
+    cerr << "Comparison against baseline:" << endl;
+    for (const auto& result: results) {
+      auto match = find_if(baseline.begin(), baseline.end(), [&](const BenchmarkResult& old) {
+        return old.engine == result.engine && old.numElems == result.numElems;
+      });
+      if (match == baseline.end()) {
+        cerr << "  " << result.engine << " @ " << addCommasTo(result.numElems) << ": no baseline" << endl;
+        continue;
+      }
+      
+      auto report = [&](const string& what, double current, double old, const string& verdict) {
+        cerr << "  " << result.engine << " @ " << addCommasTo(result.numElems) << " " << what << ": "
+             << current << " vs " << old;
+        if (old != 0) cerr << " (" << showpos << 100 * (current - old) / old << noshowpos << "%)";
+        if (!verdict.empty()) cerr << " " << verdict;
+        cerr << endl;
+        if (verdict == "REGRESSION") regressions++;
+      };
+      
+      report("build ns", result.buildMedian, match->buildMedian,
+             classifyChange(result.buildMedian, result.buildVariance, result.trials,
+                            match->buildMedian, match->buildVariance, match->trials));
+      report("query ns", result.queryMedian, match->queryMedian,
+             classifyChange(result.queryMedian, result.queryVariance, result.trials,
+                            match->queryMedian, match->queryVariance, match->trials));
+      
+      report("memory bytes", result.memory, match->memory,
+             classifyMemoryChange(result.memory, match->memory));
+      
+      if (match->correct && !result.correct) {
+        cerr << "  " << result.engine << " @ " << addCommasTo(result.numElems) << ": REGRESSION (now gives wrong answers)" << endl;
+        regressions++;
+      }
+    }
+    
+    return regressions;
+  }
+  
+  /* Runs the benchmark suite over the specified RMQ types, writes the results
+   * as JSON to standard output, and compares them against a baseline if one
+   * was given.
+   */
+  void runBenchmark(const vector<BenchmarkEngine>& engines, const TestParameters& params) {
+    vector<BenchmarkResult> results;
+    
+    for (const auto& engine: engines) {
+      for (size_t numElems: params.benchmarkSizes) {
+        if (numElems > engine.maxElems) {
+          cerr << "Skipping " << engine.name << " at size " << addCommasTo(numElems) << "." << endl;
+          continue;
+        }
+        
+        cerr << "Benchmarking " << engine.name << " at size " << addCommasTo(numElems) << "..." << endl;
+        results.push_back(engine.run(engine.name, numElems, params));
+        if (!results.back().correct) {
+          cerr << "Warning: " << engine.name << " gave wrong answers at size " << addCommasTo(numElems) << "." << endl;
+        }
+      }
+    }
+    
+    writeBenchmarkJSON(cout, results, params);
+    
+    if (!params.baselineFile.empty()) {
+      size_t regressions = compareToBaseline(results, readBenchmarkJSON(params.baselineFile));
+      if (regressions > 0) {
+        throw runtime_error(to_string(regressions) + " regression(s) against the baseline.");
+      }
+    }
+  }
+  
+  /* Parses the command-line arguments by building a map from flags to values. */
+  auto parseArguments(int argc, const char* argv[]) {
+    unordered_map<string, string> result;
+    
+    for (int i = 1; i < argc; i += 2) {
+      string flag = argv[i];
+      if (!kAllSwitches.count(flag)) throw runtime_error("Unknown command-line switch: " + flag);
+      
+      if (i + 1 == argc) throw runtime_error("Command line switch " + flag + " missing argument.");
+      
+      if (result.count(flag)) throw runtime_error("Duplicate command-line switch: " + flag);
+      
+      result[flag] = argv[i + 1];
+    }
+    
+    return result;
+  }
+  
+  /* Converts a string to lower-case. */
+  string toLowerCase(string input) {
+    transform(input.begin(), input.end(), input.begin(), ::tolower);
+    return input;
+  }
+  
+  /* Converts an "on" or "off" switch value to a bool. */
+  bool parseOnOff(const string& input) {
+    string value = toLowerCase(input);
+    if (value == "on")  return true;
+    if (value == "off") return false;
+    throw runtime_error("Could not parse \"" + input + "\" as on or off.");
+  }
+  
+  /* Picks which test to run for an RMQ type that supports every mode. */
+  template <typename RMQ> function<void (const TestParameters&)> selectMode(const string& mode) {
+    if (mode == "rmq") return &testRMQ<RMQ>;
+    if (mode == "lca") return &testLCA<RMQ>;
+    if (mode == "lce") return &testLCE<RMQ>;
+    if (mode == "cache") return &testCache<RMQ>;
+    if (mode == "topk")  return &testTopK<RMQ>;
+    if constexpr (RangeUpdatable<RMQ>) {
+      if (mode == "updates") return &testUpdates<RMQ>;
+    }
+    if constexpr (ThresholdSearchable<RMQ>) {
+      if (mode == "threshold") return &testThreshold<RMQ>;
+    }
+    if constexpr (OrderStatistics<RMQ>) {
+      if (mode == "kth") return &testKth<RMQ>;
+    }
+    if constexpr (Versioned<RMQ>) {
+      if (mode == "versions") return &testVersions<RMQ>;
+    }
+    
+    throw runtime_error("Unrecognized mode: " + mode + ". (Not every RMQ type supports every mode.)");
+  }
+  
+  /* Picks which test function to run. */
+  function<void (const TestParameters&)> selectTestFunction(const unordered_map<string, string>& args) {
+    if (!args.count("-rmq")) throw runtime_error("No RMQ type selected. Use the syntax ./run-tests -rmq ClassName to choose an RMQ type.");
+    
+    string rmqType = toLowerCase(args.at("-rmq"));
+    string mode    = args.count("-mode")? toLowerCase(args.at("-mode")) : "rmq";
+    
+    /* Hardware counters, array shapes, and in-place rebuilds only apply to the
+     * standard RMQ tests, so asking for them anywhere else is an error rather
+     * than something to quietly ignore.
+     */
+    vector<string> rmqOnly;
+    if (args.count("-counters") && parseOnOff(args.at("-counters"))) rmqOnly.push_back("-counters");
+    if (args.count("-input") && toLowerCase(args.at("-input")) != "random") rmqOnly.push_back("-input");
+    if (args.count("-rebuild") && parseOnOff(args.at("-rebuild"))) rmqOnly.push_back("-rebuild");
+    if (!rmqOnly.empty() && mode != "rmq") throw runtime_error(rmqOnly.front() + " is only supported in mode rmq.");
+    
+    /* Strip off extensions. */
+    size_t dotIndex = rmqType.find('.');
+    if (dotIndex != string::npos) {
+      rmqType = rmqType.substr(0, dotIndex);
+    }
+    
+    /* The benchmark can run either everything or just one type. */
+    if (mode == "benchmark") {
+      vector<BenchmarkEngine> engines;
+      for (const auto& engine: kBenchmarkEngines) {
+        if (rmqType == "all" || rmqType == toLowerCase(engine.name)) engines.push_back(engine);
+      }
+      if (engines.empty()) throw runtime_error("The " + args.at("-rmq") + " type can't be benchmarked.");
+      
+      return [engines](const TestParameters& params) {
+        runBenchmark(engines, params);
+      };
+    }
+    
+    if (rmqType == "adaptiverunrmq") return selectMode<AdaptiveRunRMQ>(mode);
+    if (rmqType == "fastestrmq")     return selectMode<FastestRMQ>(mode);
+    if (rmqType == "fischerheunrmq") return selectMode<FischerHeunRMQ>(mode);
+    if (rmqType == "hybridrmq")      return selectMode<HybridRMQ>(mode);
+    if (rmqType == "lazyfischerheunrmq") return selectMode<LazyFischerHeunRMQ>(mode);
+    if (rmqType == "lazysegmenttreermq") return selectMode<LazySegmentTreeRMQ>(mode);
+    if (rmqType == "persistentsegmenttreermq") return selectMode<PersistentSegmentTreeRMQ>(mode);
+    if (rmqType == "precomputedrmq") return selectMode<PrecomputedRMQ>(mode);
+    if (rmqType == "sparsetablermq") return selectMode<SparseTableRMQ>(mode);
+    if (rmqType == "segmenttreermq") return selectMode<SegmentTreeRMQ>(mode);
+    if (rmqType == "waveletmatrixrmq") return selectMode<WaveletMatrixRMQ>(mode);
+    
+    /* These types only support their own tests. */
+    if (mode != "rmq") throw runtime_error("The " + args.at("-rmq") + " type doesn't support mode " + mode + ".");
+    if (!rmqOnly.empty() && rmqType != "tinyrmq") throw runtime_error("The " + args.at("-rmq") + " type doesn't support " + rmqOnly.front() + ".");
+    
+    if (rmqType == "externalrmq")    return &testExternalRMQ;
+    if (rmqType == "hybridminmaxrmq") return &testMinMax<HybridMinMaxRMQ, HybridRMQ>;
+    if (rmqType == "multicolumnrmq") return &testMultiColumnRMQ;
+    if (rmqType == "offlinermq")     return &testOfflineRMQ;
+    if (rmqType == "rowblock2drmq")  return &testGrid<RowBlock2DRMQ<HybridRMQ>, 4096>;
+    if (rmqType == "rowblocksparsetable2drmq") return &testGrid<RowBlock2DRMQ<SparseTableRMQ>, 2048>;
+    if (rmqType == "sparsetable2drmq") return &testGrid<SparseTable2DRMQ, 1024>;
+    if (rmqType == "sparsetableminmaxrmq") return &testMinMax<SparseTableMinMaxRMQ, SparseTableRMQ>;
+    if (rmqType == "tinyrmq")        return &testTinyRMQ<TinyRMQ<64>>;
+    
+    throw runtime_error("Unrecognized RMQ type: " + args.at("-rmq") + ". (Check your spelling?)");
+  }
+  
+  /* Converts a string to a size_t. */
+  size_t stringToSizeT(const string& input) {
+    istringstream converter(input);
+    
+    size_t result;
+    char leftover;
+    if (!(converter >> result) || converter >> leftover) throw runtime_error("Could not parse \"" + input + "\" as a size_t.");
+    
+    return result;
+  }
+  
+  /* Sets up the test arguments. */
+  TestParameters selectTestParameters(const unordered_map<string, string>& args) {
+    TestParameters result;
+    
+    /* Set the random seed. */
+    result.seed = args.count("-seed")? stringToSizeT(args.at("-seed")) : 0;
+    
+    /* Turn on hardware counters, if requested. */
+    result.counters = args.count("-counters")? parseOnOff(args.at("-counters")) : false;
+    
+    /* Turn on huge pages, if requested. */
+    result.hugePages = args.count("-hugepages")? parseOnOff(args.at("-hugepages")) : false;
+    
+    /* Pick the shape of the test arrays. */
+    result.input = args.count("-input")? toLowerCase(args.at("-input")) : "random";
+    if (!kAllInputs.count(result.input)) throw runtime_error("Unknown input type: \"" + args.at("-input") + "\"");
+    
+    /* Reuse engines across builds, if requested. */
+    result.rebuild = args.count("-rebuild")? parseOnOff(args.at("-rebuild")) : false;
+    
+    /* Set up the benchmark grid. */
+    result.benchmarkSizes.clear();
+    if (args.count("-sizes")) {
+      istringstream sizes(args.at("-sizes"));
+      for (string size; getline(sizes, size, ','); ) {
+        result.benchmarkSizes.push_back(stringToSizeT(size));
+        if (result.benchmarkSizes.back() == 0) throw runtime_error("Benchmark sizes must be positive.");
+      }
+    } else {
+      result.benchmarkSizes = { 10, 1000, 10000, 100000 };
+    }
+    result.benchmarkBuilds  = args.count("-builds")?  stringToSizeT(args.at("-builds"))  : 5;
+    result.benchmarkQueries = args.count("-queries")? stringToSizeT(args.at("-queries")) : 100000;
+    result.benchmarkTrials  = args.count("-trials")?  stringToSizeT(args.at("-trials"))  : 5;
+    if (result.benchmarkBuilds == 0 || result.benchmarkQueries == 0 || result.benchmarkTrials == 0) {
+      throw runtime_error("Benchmark builds, queries, and trials must be positive.");
+    }
+    result.baselineFile = args.count("-baseline")? args.at("-baseline") : "";
     
     /* Set the printer. */
     if (args.count("-output")) {
@@ -265,9 +2293,10 @@ int main(int argc, const char* argv[]) try {
   
   auto testFn    = selectTestFunction(args);
   auto testArgs  = selectTestParameters(args);
+  setHugePagesEnabled(testArgs.hugePages);
   
   testFn(testArgs);
 } catch (const exception& e) {
-  cout << "Error: " << e.what() << endl;
+  cerr << "Error: " << e.what() << endl;
   return -1;
 }
@@ -3,7 +3,7 @@
 using namespace std;
 
 /* Constructor recursively assembles the tree. */
-SegmentTreeRMQ::SegmentTreeRMQ(const RMQEntry* elems, size_t numElems) : elems(elems) {
+SegmentTreeRMQ::SegmentTreeRMQ(const RMQEntry* elems, size_t numElems) : elems(elems), numElems(numElems) {
   root = makeTree(0, numElems);
 }
 
@@ -17,6 +17,16 @@ size_t SegmentTreeRMQ::rmq(size_t low, size_t high) const {
   return rmqRec(root, low, high);
 }
 
+/* Threshold search also fires off a recursive search. */
+size_t SegmentTreeRMQ::firstBelow(size_t low, size_t high, RMQEntry threshold) const {
+  return firstBelowRec(root, low, high, threshold);
+}
+
+/* A tree over n elements has n leaves and n - 1 internal nodes. */
+size_t SegmentTreeRMQ::memoryUsage() const {
+  return sizeof(*this) + (numElems == 0? 0 : 2 * numElems - 1) * sizeof(Node);
+}
+
 /**** Actual Implementation Details ****/
 
 /* Recursively builds a segment tree over the specified range. */
@@ -70,6 +80,28 @@ size_t SegmentTreeRMQ::rmqRec(Node* tree, size_t low, size_t high) const {
   return elems[left] < elems[right]? left : right;
 }
 
+/* Recursively searches for the first value below the threshold. As with RMQ
+ * searches, once the search range splits across two children, each side is
+ * flush against an edge of its child. Every node below that whose minimum is
+ * too big is skipped in O(1), and the first node whose minimum is small enough
+ * contains the answer, so only one path is ever followed all the way down.
+ */
+size_t SegmentTreeRMQ::firstBelowRec(Node* tree, size_t low, size_t high, RMQEntry threshold) const {
+  /* Base case: Nothing in this node is small enough. */
+  if (low >= high || !(elems[tree->minIndex] < threshold)) return high;
+  
+  /* Base case: A whole leaf whose value is small enough. */
+  if (tree->left == nullptr) return tree->low;
+  
+  /* Recursive case: Try the left half first, then the right. */
+  size_t mid = tree->low + (tree->high - tree->low) / 2;
+  if (low < mid) {
+    size_t result = firstBelowRec(tree->left, low, min(high, mid), threshold);
+    if (result < min(high, mid)) return result;
+  }
+  return high > mid? firstBelowRec(tree->right, max(low, mid), high, threshold) : high;
+}
+
 /* Cleans up the given tree. */
 void SegmentTreeRMQ::freeTree(Node* tree) {
   if (tree == nullptr) return;
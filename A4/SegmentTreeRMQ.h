@@ -156,6 +156,18 @@ public:
    */
   std::size_t rmq(std::size_t low, std::size_t high) const;
 
+  /* Returns the first index in [low, high) whose value is strictly less than
+   * the threshold, or high if there isn't one. This descends the tree once,
+   * skipping any node whose minimum isn't below the threshold, so it takes
+   * O(log n) time.
+   */
+  std::size_t firstBelow(std::size_t low, std::size_t high, RMQEntry threshold) const;
+
+  /* Returns the number of bytes of memory used by this RMQ structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const;
+
 private:
   struct Node {
     std::size_t low, high; // Bounds, which are half-open
@@ -167,6 +179,7 @@ private:
   
   Node* root;
   const RMQEntry* elems; // Pointer to the master elements array.
+  std::size_t numElems;  // Number of elements in that array.
   
   /* Builds a segment tree. */
   Node* makeTree(std::size_t low, std::size_t high) const;
@@ -174,6 +187,9 @@ private:
   /* Performs a query on the tree. */
   std::size_t rmqRec(Node* root, std::size_t low, std::size_t high) const;
   
+  /* Performs a threshold search on the tree, returning high if it fails. */
+  std::size_t firstBelowRec(Node* root, std::size_t low, std::size_t high, RMQEntry threshold) const;
+  
   /* Cleans things up. */
   void freeTree(Node* root);
   
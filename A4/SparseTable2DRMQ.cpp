@@ -0,0 +1,81 @@
+#include "SparseTable2DRMQ.h"
+#include <bit>
+#include <stdexcept>
+using namespace std;
+
+SparseTable2DRMQ::SparseTable2DRMQ(const RMQEntry* elems, size_t numRows, size_t numCols)
+  : array(elems), numRows(numRows), numCols(numCols) {
+  if (numRows * numCols > UINT32_MAX) throw length_error("Too many cells for 32-bit cell indices.");
+
+  rowLevels = bit_width(numRows);
+  colLevels = bit_width(numCols);
+  levels.resize(rowLevels * colLevels);
+  if (levels.empty()) return;
+
+  auto smaller = [&](uint32_t lhs, uint32_t rhs) {
+    return elems[rhs] < elems[lhs]? rhs : lhs;
+  };
+
+  /* Level (0, 0) is every cell by itself. Each level (0, j) joins two
+   * side-by-side rectangles from level (0, j - 1), and each level (i, j)
+   * joins two stacked rectangles from level (i - 1, j).
+   */
+  levels[0].resize(numRows * numCols);
+  for (size_t cell = 0; cell < levels[0].size(); cell++) {
+    levels[0][cell] = cell;
+  }
+
+  for (size_t j = 1; j < colLevels; j++) {
+    const Level& prev = levels[j - 1];
+    Level& curr = levels[j];
+    curr.resize(numRows * stride(j));
+
+    size_t half = size_t(1) << (j - 1);
+    for (size_t r = 0; r < numRows; r++) {
+      for (size_t c = 0; c < stride(j); c++) {
+        curr[r * stride(j) + c] = smaller(prev[r * stride(j - 1) + c],
+                                          prev[r * stride(j - 1) + c + half]);
+      }
+    }
+  }
+
+  for (size_t i = 1; i < rowLevels; i++) {
+    size_t half = size_t(1) << (i - 1);
+    for (size_t j = 0; j < colLevels; j++) {
+      const Level& prev = levels[(i - 1) * colLevels + j];
+      Level& curr = levels[i * colLevels + j];
+      curr.resize((numRows + 1 - 2 * half) * stride(j));
+
+      for (size_t cell = 0; cell < curr.size(); cell++) {
+        curr[cell] = smaller(prev[cell], prev[cell + half * stride(j)]);
+      }
+    }
+  }
+}
+
+GridPosition SparseTable2DRMQ::rmq(size_t rowLow, size_t rowHigh,
+                                   size_t colLow, size_t colHigh) const {
+  size_t i = bit_width(rowHigh - rowLow) - 1;
+  size_t j = bit_width(colHigh - colLow) - 1;
+  size_t rowOther = rowHigh - (size_t(1) << i);
+  size_t colOther = colHigh - (size_t(1) << j);
+
+  const Level& table = level(i, j);
+  size_t width = stride(j);
+  uint32_t best = table[rowLow * width + colLow];
+  for (uint32_t cell: { table[rowLow   * width + colOther],
+                        table[rowOther * width + colLow],
+                        table[rowOther * width + colOther] }) {
+    if (array[cell] < array[best]) best = cell;
+  }
+
+  return { best / numCols, best % numCols };
+}
+
+size_t SparseTable2DRMQ::memoryUsage() const {
+  size_t result = sizeof(*this) + levels.capacity() * sizeof(Level);
+  for (const auto& table: levels) {
+    result += table.capacity() * sizeof(uint32_t);
+  }
+  return result;
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * File: SparseTable2DRMQ.h
+ *
+ * A two-dimensional range minimum query data structure implemented using a
+ * two-dimensional sparse table.
+ *
+ * For every pair of powers of two 2^i and 2^j, the table stores the position
+ * of the minimum of every 2^i x 2^j rectangle in the grid. Any query rectangle
+ * is covered by four (possibly overlapping) such rectangles, one anchored at
+ * each of its corners, so a query takes O(1) time.
+ *
+ * The price is O(rc log r log c) space for an r x c grid. At 4 bytes per
+ * entry, a 1024 x 1024 grid already needs about 340MB, so this is only
+ * practical for grids up to about that size. RowBlock2DRMQ is the memory-lean
+ * alternative.
+ */
+
+#ifndef SparseTable2DRMQ_Included
+#define SparseTable2DRMQ_Included
+
+#include "RMQEntry.h"
+#include "GridPosition.h"
+#include "HugePageAllocator.h"
+#include <vector>
+#include <cstdint>
+
+class SparseTable2DRMQ {
+public:
+  /* Constructs an RMQ structure over the specified grid of elements, which is
+   * stored in row-major order. The grid may be empty, and must have fewer than
+   * 2^32 cells.
+   *
+   * As with the one-dimensional types, the elements array must remain valid,
+   * and unchanged, for the lifetime of this data structure.
+   */
+  SparseTable2DRMQ(const RMQEntry* elems, std::size_t numRows, std::size_t numCols);
+
+  /* Returns the position of the minimum of the rectangle made of rows
+   * [rowLow, rowHigh) and columns [colLow, colHigh). You can assume that both
+   * ranges are nonempty and in bounds.
+   */
+  GridPosition rmq(std::size_t rowLow, std::size_t rowHigh,
+                   std::size_t colLow, std::size_t colHigh) const;
+
+  /* Returns the number of bytes of memory used by this RMQ structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const;
+
+private:
+  /* One table per pair of levels. Level (i, j) only has entries for the
+   * rectangles that fit in the grid, so each of its rows holds
+   * numCols + 1 - 2^j entries. Entry (r, c) is the cell index of the minimum of
+   * the 2^i x 2^j rectangle whose top-left corner is (r, c).
+   */
+  using Level = std::vector<std::uint32_t, HugePageAllocator<std::uint32_t>>;
+
+  const RMQEntry* array;
+  std::size_t numRows, numCols;
+  std::size_t rowLevels, colLevels;
+  std::vector<Level> levels;
+
+  /* Returns the table for level (i, j). */
+  const Level& level(std::size_t i, std::size_t j) const {
+    return levels[i * colLevels + j];
+  }
+
+  /* Returns the number of entries in each row of a level (i, j) table. */
+  std::size_t stride(std::size_t j) const {
+    return numCols + 1 - (std::size_t(1) << j);
+  }
+
+  /* Copying is disabled. */
+  SparseTable2DRMQ(const SparseTable2DRMQ &) = delete;
+  void operator= (SparseTable2DRMQ) = delete;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#include "SparseTableMinMaxRMQ.h"
+#include <bit>
+#include <stdexcept>
+using namespace std;
+
+SparseTableMinMaxRMQ::SparseTableMinMaxRMQ(const RMQEntry* elems, size_t numElems) : array(elems) {
+  if (numElems > UINT32_MAX) throw length_error("Too many elements for 32-bit indices.");
+  if (numElems == 0) return;
+
+  levels.resize(bit_width(numElems));
+  levels[0].resize(numElems);
+  for (size_t i = 0; i < numElems; i++) {
+    levels[0][i] = { uint32_t(i), uint32_t(i) };
+  }
+
+  /* Ties go to the left block on both sides, so both answers are leftmost. */
+  for (size_t k = 1; k < levels.size(); k++) {
+    const Level& prev = levels[k - 1];
+    Level& curr = levels[k];
+    size_t half = size_t(1) << (k - 1);
+    curr.resize(numElems + 1 - 2 * half);
+
+    for (size_t i = 0; i < curr.size(); i++) {
+      Entry left = prev[i], right = prev[i + half];
+      curr[i] = { elems[right.min] < elems[left.min]? right.min : left.min,
+                  elems[left.max] < elems[right.max]? right.max : left.max };
+    }
+  }
+}
+
+/* Same shape as SparseTableRMQ::rmq: the two (possibly identical) blocks
+ * covering the range are both looked up, and each answer is picked with a
+ * select rather than a branch.
+ */
+MinMaxPosition SparseTableMinMaxRMQ::rmq(size_t low, size_t high) const {
+  size_t row = bit_width((high - low - 1) | 1) - 1;
+  const Level& level = levels[row];
+
+  Entry left  = level[low];
+  Entry right = level[high - (size_t(1) << row)];
+  return { array[right.min] < array[left.min]? right.min : left.min,
+           array[left.max] < array[right.max]? right.max : left.max };
+}
+
+size_t SparseTableMinMaxRMQ::memoryUsage() const {
+  size_t result = sizeof(*this) + levels.capacity() * sizeof(Level);
+  for (const Level& level: levels) {
+    result += level.capacity() * sizeof(Entry);
+  }
+  return result;
+}
@@ -0,0 +1,63 @@
+/******************************************************************************
+ * File: SparseTableMinMaxRMQ.h
+ *
+ * A sparse table that answers range minimum and range maximum queries over
+ * the same range with a single lookup.
+ *
+ * Each entry of the table holds the index of the minimum and the index of the
+ * maximum of its block as a pair of 32-bit values, so both live in the same
+ * 8 bytes and always share a cache line. A query reads the same two entries it
+ * would for a plain RMQ and gets both answers out of them, so it costs about
+ * as much as one RMQ rather than two.
+ *
+ * Arrays must have fewer than 2^32 elements.
+ */
+
+#ifndef SparseTableMinMaxRMQ_Included
+#define SparseTableMinMaxRMQ_Included
+
+#include "RMQEntry.h"
+#include "MinMaxPosition.h"
+#include "HugePageAllocator.h"
+#include <vector>
+#include <cstdint>
+
+class SparseTableMinMaxRMQ {
+public:
+  /* Constructs a min/max structure from the specified array of elements. That
+   * array may be empty.
+   *
+   * As with the other RMQ types, the array must remain valid, and unchanged,
+   * for the lifetime of this data structure.
+   */
+  SparseTableMinMaxRMQ(const RMQEntry* elems, std::size_t numElems);
+
+  /* Returns the indices of the leftmost minimum and the leftmost maximum of
+   * [low, high). You can assume that low < high and that the bounds are in
+   * range.
+   */
+  MinMaxPosition rmq(std::size_t low, std::size_t high) const;
+
+  /* Returns the number of bytes of memory used by this structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const;
+
+private:
+  /* Where the extremes of one block are. */
+  struct Entry {
+    std::uint32_t min, max;
+  };
+
+  /* Level k has an entry for each 2^k-element block that fits in the array. */
+  using Level = std::vector<Entry, HugePageAllocator<Entry>>;
+
+  const RMQEntry* array;
+  std::vector<Level> levels;
+
+  /* Copying is disabled. */
+  SparseTableMinMaxRMQ(const SparseTableMinMaxRMQ &) = delete;
+  void operator= (SparseTableMinMaxRMQ) = delete;
+};
+
+#endif
@@ -1,6 +1,16 @@
 #include "SparseTableRMQ.h"
+#include <bit>
 
 SparseTableRMQ::SparseTableRMQ(const RMQEntry* elems, std::size_t numElems) {
+  rebuild(elems, numElems);
+}
+
+/* Every table is cleared rather than freed, so a rebuild over an array no
+ * larger than the last one refills the same storage. Levels left over from a
+ * larger array stay allocated but empty.
+ */
+void SparseTableRMQ::rebuild(const RMQEntry* elems, std::size_t numElems) {
+  logTable.clear();
   logTable.reserve((numElems)+1);
   logTable.emplace_back(0);
   logTable.emplace_back(0);
@@ -9,30 +19,26 @@ SparseTableRMQ::SparseTableRMQ(const RMQEntry* elems, std::size_t numElems) {
     logTable.emplace_back(logTable[i/2] + 1);
   }
 
-  indexVector.reserve(logTable.back()+1);
-  for(std::size_t i = 0; i < (logTable.back()+1); i = i + 1)
+  if (indexVector.size() < logTable.back()+1)
+  {
+    indexVector.resize(logTable.back()+1);
+  }
+  for (auto& level: indexVector)
   {
-     std::vector<std::size_t> row;
-     indexVector.emplace_back(row);
+    level.clear();
   }
   
   array = elems;
   
-  int q = 0;
-  while(q == 0)
+  indexVector[0].reserve(numElems);
+  for(std::size_t i = 0; i < numElems; i = i+1)
   {
-    indexVector[0].reserve(numElems);
-    for(std::size_t i = 0; i < numElems; i = i+1)
-    {
-
-      indexVector[0].emplace_back(i);
-    }
-    q++;
+    indexVector[0].emplace_back(i);
   }
 
-  for(std::size_t i = 1; i < indexVector.size(); i = i+1)
+  for(std::size_t i = 1; i < logTable.back()+1; i = i+1)
   {    
-    indexVector[i].reserve(numElems);
+    indexVector[i].reserve(numElems + 1 - (1 << i));
     for(std::size_t j = 0; j +(1<<i) <= numElems; j = j+1)
     {
         if(elems[indexVector[i-1][j]]<elems[indexVector[i-1][j+(1<<(i-1))]])
@@ -44,34 +50,49 @@ SparseTableRMQ::SparseTableRMQ(const RMQEntry* elems, std::size_t numElems) {
             indexVector[i].emplace_back(indexVector[i-1][j+(1<<(i-1))]);
           }
     }
-  //draw();
   }
-  //draw();
 }
 
 SparseTableRMQ::~SparseTableRMQ() {
   indexVector.clear();
 }
 
+/* Queries are branch-free: the two (possibly identical) blocks covering the
+ * range are always both looked up, and the smaller one is picked with a
+ * select rather than a jump, since that comparison is a coin flip on random
+ * data. The row comes from counting bits rather than from the log table so
+ * that there's one less memory access on the critical path; it matches
+ * logTable[length - 1], since that's the deepest level the table builds.
+ */
 std::size_t SparseTableRMQ::rmq(std::size_t low, std::size_t high) const {
-  std::size_t length = (high) - low;
-  std::size_t row = logTable[length - 1];
-  std::size_t highLog = logTable[length-1];
-  
+  std::size_t row = std::bit_width((high - low - 1) | 1) - 1;
+  const Level& level = indexVector[row];
 
-  if(1 == length)
-  {
-    return indexVector[row][low];
-  }
-  else if(array[indexVector[highLog][low]]<array[indexVector[highLog][high - (1 << highLog)]])
-  {
-    return indexVector[highLog][low];
-  }
-  else
-  {
-    return indexVector[highLog][high- (1 <<row)];
+  std::size_t left  = level[low];
+  std::size_t right = level[high - (std::size_t(1) << row)];
+  return array[right] < array[left]? right : left;
+}
+
+/* One RMQ tells us whether there's an answer at all, and if so, the minimum
+ * itself is a value below the threshold, so the answer can't be past it. The
+ * search then skips ahead from low by blocks of decreasing powers of two,
+ * taking each block whose minimum isn't below the threshold. Since every
+ * prefix of a skippable run is also skippable, this finds the length of the
+ * longest run starting at low one bit at a time, and the answer is whatever
+ * comes right after that run.
+ */
+std::size_t SparseTableRMQ::firstBelow(std::size_t low, std::size_t high, RMQEntry threshold) const {
+  std::size_t smallest = rmq(low, high);
+  if (!(array[smallest] < threshold)) return high;
+
+  std::size_t pos = low;
+  for (std::size_t row = std::bit_width(smallest - low); row-- > 0; ) {
+    std::size_t length = std::size_t(1) << row;
+    if (pos + length <= smallest && !(array[indexVector[row][pos]] < threshold)) {
+      pos += length;
+    }
   }
-  
+  return pos;
 }
 
 void SparseTableRMQ::draw()
@@ -82,3 +103,12 @@ void SparseTableRMQ::draw()
         std::cout << std::endl;
 }
 }
+
+std::size_t SparseTableRMQ::memoryUsage() const {
+  std::size_t result = sizeof(*this) + indexVector.capacity() * sizeof(indexVector[0])
+                     + logTable.capacity() * sizeof(logTable[0]);
+  for (const auto& row: indexVector) {
+    result += row.capacity() * sizeof(row[0]);
+  }
+  return result;
+}
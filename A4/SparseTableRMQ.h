@@ -8,6 +8,7 @@
 #define SparseTableRMQ_Included
 
 #include "RMQEntry.h"
+#include "HugePageAllocator.h"
 #include <vector>
 #include <iostream>
 
@@ -23,6 +24,12 @@ public:
    * structures, nor should you delete it.
    */
   SparseTableRMQ(const RMQEntry* elems, std::size_t numElems);
+
+  /* Rebuilds this structure over a new array, as if it had just been
+   * constructed from it. The existing tables are reused, so this allocates no
+   * memory unless the new array is larger than any seen before.
+   */
+  void rebuild(const RMQEntry* elems, std::size_t numElems);
   
   /* Frees all memory associated with this RMQ structure. */
   ~SparseTableRMQ();
@@ -39,12 +46,26 @@ public:
    * rather than the minimum value itself.
    */
   std::size_t rmq(std::size_t low, std::size_t high) const;
+
+  /* Returns the first index in [low, high) whose value is strictly less than
+   * the threshold, or high if there isn't one. Takes O(log n) time.
+   */
+  std::size_t firstBelow(std::size_t low, std::size_t high, RMQEntry threshold) const;
+
+  /* Returns the number of bytes of memory used by this RMQ structure, not
+   * counting the elements array itself.
+   */
+  std::size_t memoryUsage() const;
+
   void draw();
 
 private:
-  std::vector<std::vector<std::size_t>> indexVector;
+  /* Levels are the big tables, so they may live on huge pages. */
+  using Level = std::vector<std::size_t, HugePageAllocator<std::size_t>>;
+
+  std::vector<Level> indexVector;
   const RMQEntry* array;
-  std::vector<std::size_t> logTable;
+  std::vector<std::size_t, HugePageAllocator<std::size_t>> logTable;
   /* Copying is disabled. */
   SparseTableRMQ(const SparseTableRMQ &) = delete;
   void operator= (SparseTableRMQ) = delete;
@@ -0,0 +1,178 @@
+#include "SuffixArray.h"
+#include <limits>
+using namespace std;
+
+namespace {
+  const size_t kEmpty = numeric_limits<size_t>::max();
+
+  /* Whether position i is a leftmost S-type position. */
+  bool isLMS(const vector<bool>& isSType, size_t i) {
+    return i > 0 && isSType[i] && !isSType[i - 1];
+  }
+
+  /* Fills in the start (or one past the end) of each character's bucket. */
+  void findBuckets(const vector<size_t>& text, size_t alphabetSize,
+                   vector<size_t>& buckets, bool ends) {
+    buckets.assign(alphabetSize, 0);
+    for (size_t ch: text) {
+      buckets[ch]++;
+    }
+
+    size_t sum = 0;
+    for (size_t ch = 0; ch < alphabetSize; ch++) {
+      sum += buckets[ch];
+      buckets[ch] = ends? sum : sum - buckets[ch];
+    }
+  }
+
+  /* Given the LMS positions in the order they should appear, induces the order
+   * of all the L-type and then all the S-type suffixes.
+   */
+  void induceSort(const vector<size_t>& text, size_t alphabetSize,
+                  const vector<bool>& isSType, const vector<size_t>& lms,
+                  vector<size_t>& suffixArray) {
+    vector<size_t> buckets;
+    suffixArray.assign(text.size(), kEmpty);
+
+    /* Drop the LMS positions at the ends of their buckets. */
+    findBuckets(text, alphabetSize, buckets, true);
+    for (size_t i = lms.size(); i > 0; i--) {
+      suffixArray[--buckets[text[lms[i - 1]]]] = lms[i - 1];
+    }
+
+    /* L-type suffixes fill in from the fronts of the buckets. */
+    findBuckets(text, alphabetSize, buckets, false);
+    for (size_t i = 0; i < text.size(); i++) {
+      size_t pos = suffixArray[i];
+      if (pos != kEmpty && pos > 0 && !isSType[pos - 1]) {
+        suffixArray[buckets[text[pos - 1]]++] = pos - 1;
+      }
+    }
+
+    /* S-type suffixes fill in from the backs of the buckets. */
+    findBuckets(text, alphabetSize, buckets, true);
+    for (size_t i = text.size(); i > 0; i--) {
+      size_t pos = suffixArray[i - 1];
+      if (pos != kEmpty && pos > 0 && isSType[pos - 1]) {
+        suffixArray[--buckets[text[pos - 1]]] = pos - 1;
+      }
+    }
+  }
+
+  /* Builds the suffix array of a text that ends with a unique, smallest
+   * sentinel character and whose characters are all below alphabetSize.
+   */
+  vector<size_t> sais(const vector<size_t>& text, size_t alphabetSize) {
+    size_t n = text.size();
+    vector<size_t> suffixArray;
+    if (n == 1) return { 0 };
+
+    /* Classify each suffix. The sentinel suffix is S-type by convention. */
+    vector<bool> isSType(n, false);
+    isSType[n - 1] = true;
+    for (size_t i = n - 1; i > 0; i--) {
+      isSType[i - 1] = text[i - 1] < text[i] || (text[i - 1] == text[i] && isSType[i]);
+    }
+
+    vector<size_t> lms;
+    for (size_t i = 1; i < n; i++) {
+      if (isLMS(isSType, i)) lms.push_back(i);
+    }
+
+    /* Sort the LMS substrings with one round of induced sorting. */
+    induceSort(text, alphabetSize, isSType, lms, suffixArray);
+
+    /* Name each LMS substring by its rank, giving equal substrings equal
+     * names.
+     */
+    vector<size_t> names(n, kEmpty);
+    size_t numNames = 0;
+    size_t prev = kEmpty;
+    for (size_t pos: suffixArray) {
+      if (!isLMS(isSType, pos)) continue;
+
+      bool differs = prev == kEmpty;
+      for (size_t d = 0; !differs; d++) {
+        if (text[pos + d] != text[prev + d] || isSType[pos + d] != isSType[prev + d]) {
+          differs = true;
+        } else if (d > 0 && isLMS(isSType, pos + d)) {
+          break;
+        }
+      }
+
+      if (differs) numNames++;
+      names[pos] = numNames - 1;
+      prev = pos;
+    }
+
+    /* Sort the LMS suffixes, recursing if the names aren't unique. */
+    vector<size_t> reduced;
+    reduced.reserve(lms.size());
+    for (size_t pos: lms) {
+      reduced.push_back(names[pos]);
+    }
+
+    vector<size_t> reducedSA;
+    if (numNames < lms.size()) {
+      reducedSA = sais(reduced, numNames);
+    } else {
+      reducedSA.resize(lms.size());
+      for (size_t i = 0; i < reduced.size(); i++) {
+        reducedSA[reduced[i]] = i;
+      }
+    }
+
+    vector<size_t> sortedLMS;
+    sortedLMS.reserve(lms.size());
+    for (size_t index: reducedSA) {
+      sortedLMS.push_back(lms[index]);
+    }
+
+    /* Induce the full order from the sorted LMS suffixes. */
+    induceSort(text, alphabetSize, isSType, sortedLMS, suffixArray);
+    return suffixArray;
+  }
+}
+
+vector<size_t> buildSuffixArray(const string& text) {
+  /* Shift every character up by one to make room for the sentinel. */
+  vector<size_t> shifted;
+  shifted.reserve(text.size() + 1);
+  for (char ch: text) {
+    shifted.push_back(static_cast<unsigned char>(ch) + 1);
+  }
+  shifted.push_back(0);
+
+  vector<size_t> suffixArray = sais(shifted, 257);
+
+  /* The sentinel suffix always comes first; drop it. */
+  suffixArray.erase(suffixArray.begin());
+  return suffixArray;
+}
+
+vector<size_t> buildLCPArray(const string& text, const vector<size_t>& suffixArray) {
+  size_t n = text.size();
+  vector<size_t> rank(n);
+  for (size_t i = 0; i < n; i++) {
+    rank[suffixArray[i]] = i;
+  }
+
+  vector<size_t> lcp(n, 0);
+  size_t length = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (rank[i] == 0) {
+      length = 0;
+      continue;
+    }
+
+    size_t j = suffixArray[rank[i] - 1];
+    while (i + length < n && j + length < n && text[i + length] == text[j + length]) {
+      length++;
+    }
+    lcp[rank[i]] = length;
+
+    if (length > 0) length--;
+  }
+
+  return lcp;
+}
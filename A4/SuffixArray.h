@@ -0,0 +1,38 @@
+/******************************************************************************
+ * File: SuffixArray.h
+ *
+ * Linear-time suffix array and LCP array construction.
+ *
+ * The suffix array is built with the SA-IS algorithm of Nong, Zhang, and Chan.
+ * SA-IS classifies each suffix as S-type (smaller than the suffix after it) or
+ * L-type (larger), sorts the leftmost S-type positions (LMS positions) with a
+ * round of induced sorting, recursively solves the problem on the string of
+ * LMS substring names if those names aren't already unique, and then induces
+ * the order of every other suffix from the sorted LMS suffixes. Each level of
+ * the recursion works on a string at most half as long as the one above it,
+ * so the total runtime is O(n).
+ *
+ * The LCP array is built with Kasai's algorithm, which visits suffixes in text
+ * order and uses the fact that the LCP can drop by at most one from one suffix
+ * to the next. That also runs in time O(n).
+ */
+
+#ifndef SuffixArray_Included
+#define SuffixArray_Included
+
+#include <string>
+#include <vector>
+
+/* Returns the suffix array of the given text, which lists the starting
+ * positions of the text's suffixes in sorted order.
+ */
+std::vector<std::size_t> buildSuffixArray(const std::string& text);
+
+/* Returns the LCP array for the given text and its suffix array. Entry i is the
+ * length of the longest common prefix of the suffixes at positions i - 1 and i
+ * of the suffix array, and entry 0 is zero.
+ */
+std::vector<std::size_t> buildLCPArray(const std::string& text,
+                                       const std::vector<std::size_t>& suffixArray);
+
+#endif
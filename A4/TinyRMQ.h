@@ -0,0 +1,97 @@
+/******************************************************************************
+ * File: TinyRMQ.h
+ *
+ * A fixed-capacity range minimum query data structure for very small arrays
+ * (at most 64 elements). Everything lives inline in the object, so building
+ * one never touches the heap.
+ *
+ * The structure uses the "stack mask" trick. If we scan the array from left to
+ * right while maintaining the usual Cartesian tree stack (the indices whose
+ * values are no bigger than everything after them), then after processing
+ * index j, the minimum of any range [i, j] is the smallest stack index that's
+ * at least i. Since there are at most 64 indices, the whole stack fits in a
+ * single machine word, so we store one word per index. A query then becomes a
+ * mask-and-count-trailing-zeros on one of those words.
+ *
+ * Building takes amortized O(1) per element and querying takes O(1), both
+ * with tiny constant factors.
+ */
+
+#ifndef TinyRMQ_Included
+#define TinyRMQ_Included
+
+#include "RMQEntry.h"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+template <std::size_t MaxElems = 64> class TinyRMQ {
+public:
+  static_assert(MaxElems >= 1 && MaxElems <= 64, "TinyRMQ supports at most 64 elements.");
+
+  /* Largest number of elements this structure can hold. */
+  static constexpr std::size_t kCapacity = MaxElems;
+
+  /* Constructs an RMQ structure from the specified array of elements. That
+   * array may be empty, and must have at most kCapacity elements.
+   *
+   * You aren't responsible for managing the memory of the elements array
+   * provided to you here. You can assume that the array will remain valid
+   * throughout the lifetime of this data structure. You should not modify the
+   * contents of this array, as it might be shared across multiple RMQ
+   * structures, nor should you delete it.
+   */
+  TinyRMQ(const RMQEntry* elems, std::size_t numElems) {
+    Mask stack = 0;
+    for (std::size_t j = 0; j < numElems; j++) {
+      /* Pop everything strictly bigger than the new element. Ties stay put so
+       * that we report the leftmost minimum.
+       */
+      while (stack != 0) {
+        std::size_t top = std::bit_width(stack) - 1;
+        if (elems[top] <= elems[j]) break;
+        stack ^= Mask(1) << top;
+      }
+
+      stack |= Mask(1) << j;
+      masks[j] = stack;
+    }
+  }
+
+  /* Performs an RMQ over the specified range. You can assume that low < high
+   * and that the bounds are in range and don't need to do any error-handling
+   * if this is not the case.
+   *
+   * The interval here is half-open. That is, the range in question here is
+   * [low, high). Note that this follows the C++ convention, but is slightly
+   * different from how we presented things in lecture.
+   *
+   * This function should return the *index* at which the minimum value occurs,
+   * rather than the minimum value itself.
+   */
+  std::size_t rmq(std::size_t low, std::size_t high) const {
+    return std::countr_zero(Mask(masks[high - 1] & (~Mask(0) << low)));
+  }
+
+  /* Returns the number of bytes of memory used by this RMQ structure, not
+   * counting the elements array itself. This never depends on the number of
+   * elements.
+   */
+  std::size_t memoryUsage() const {
+    return sizeof(*this);
+  }
+
+private:
+  /* Narrowest word that holds one bit per element. */
+  using Mask = std::conditional_t<(MaxElems <= 32), std::uint32_t, std::uint64_t>;
+
+  /* masks[j] is the Cartesian tree stack after processing index j. */
+  std::array<Mask, MaxElems> masks;
+
+  /* Copying is disabled. */
+  TinyRMQ(const TinyRMQ &) = delete;
+  void operator= (TinyRMQ) = delete;
+};
+
+#endif
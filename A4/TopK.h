@@ -0,0 +1,85 @@
+/******************************************************************************
+ * File: TopK.h
+ *
+ * Finds the k smallest elements of a range using any of the RMQ types.
+ *
+ * The smallest element of [low, high) is the answer to one RMQ. Once we've
+ * taken it, the next smallest is the minimum of one of the two pieces on either
+ * side of it, and so on. We keep every piece we haven't taken anything from yet
+ * in a min-heap keyed on that piece's minimum, so each of the k steps is one
+ * heap pop plus two RMQs and two heap pushes. With O(1) RMQs that's O(k log k)
+ * per query, independent of the size of the range.
+ *
+ * The heap's storage is kept between queries, so once it has grown to fit the
+ * largest k asked for, queries don't allocate any memory.
+ */
+
+#ifndef TopK_Included
+#define TopK_Included
+
+#include "RMQEntry.h"
+#include <vector>
+#include <algorithm>
+
+template <typename RMQ> class TopK {
+public:
+  /* Prepares to answer top-k queries using the given RMQ structure built over
+   * the given array. Both must outlive this object.
+   */
+  TopK(const RMQ& engine, const RMQEntry* elems) : engine(engine), array(elems) {
+    // Handled in initializer list
+  }
+
+  /* Replaces the contents of out with the indices of the k smallest elements
+   * in [low, high), in order from smallest to largest, with ties going to
+   * the leftmost index. If the range has fewer than k elements, all of them
+   * are reported.
+   */
+  void topK(std::size_t low, std::size_t high, std::size_t k, std::vector<std::size_t>& out) {
+    out.clear();
+    heap.clear();
+    if (low >= high) return;
+
+    push(low, high);
+    while (out.size() < k && !heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), after);
+      Piece piece = heap.back();
+      heap.pop_back();
+
+      /* No need to split the last piece we take. */
+      out.push_back(piece.index);
+      if (out.size() == k) break;
+
+      if (piece.low < piece.index)       push(piece.low, piece.index);
+      if (piece.index + 1 < piece.high)  push(piece.index + 1, piece.high);
+    }
+  }
+
+private:
+  /* A range we haven't taken anything from, along with its minimum. */
+  struct Piece {
+    RMQEntry value;
+    std::size_t index, low, high;
+  };
+
+  const RMQ& engine;
+  const RMQEntry* array;
+  std::vector<Piece> heap;
+
+  /* Heap order: smaller values first, breaking ties by position. */
+  static bool after(const Piece& lhs, const Piece& rhs) {
+    return rhs.value < lhs.value || (rhs.value == lhs.value && rhs.index < lhs.index);
+  }
+
+  void push(std::size_t low, std::size_t high) {
+    std::size_t index = engine.rmq(low, high);
+    heap.push_back({ array[index], index, low, high });
+    std::push_heap(heap.begin(), heap.end(), after);
+  }
+
+  /* Copying is disabled. */
+  TopK(const TopK &) = delete;
+  void operator= (TopK) = delete;
+};
+
+#endif
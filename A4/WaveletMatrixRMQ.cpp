@@ -0,0 +1,234 @@
+#include "WaveletMatrixRMQ.h"
+#include <algorithm>
+#include <bit>
+#include <array>
+#include <stdexcept>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+using namespace std;
+
+namespace {
+  /* kSelectInByte[r][b] is the position of the set bit of rank r in byte b. */
+  constexpr auto kSelectInByte = [] {
+    array<array<uint8_t, 256>, 8> result{};
+    for (size_t byte = 0; byte < 256; byte++) {
+      size_t rank = 0;
+      for (size_t bit = 0; bit < 8; bit++) {
+        if (byte & (1u << bit)) result[rank++][byte] = bit;
+      }
+    }
+    return result;
+  }();
+
+  /* Position of the set bit with the given rank within a word, which must have
+   * more than rank bits set. With BMI2, pdep deposits a single bit at exactly
+   * that position. Otherwise, the word's byte counts are summed in parallel,
+   * a bytewise comparison against the rank picks the byte, and a table finds
+   * the bit within it.
+   */
+  size_t selectInWord(uint64_t word, size_t rank) {
+#ifdef __BMI2__
+    return countr_zero(_pdep_u64(uint64_t(1) << rank, word));
+#else
+    constexpr uint64_t kOnes  = 0x0101010101010101;
+    constexpr uint64_t kHighs = 0x8080808080808080;
+    
+    uint64_t counts = word - ((word >> 1) & 0x5555555555555555);
+    counts = (counts & 0x3333333333333333) + ((counts >> 2) & 0x3333333333333333);
+    counts = (counts + (counts >> 4)) & 0x0F0F0F0F0F0F0F0F;
+    uint64_t prefix = counts * kOnes; // Byte i: set bits in bytes 0 through i
+    
+    /* Each byte's top bit ends up set exactly when its prefix is at most the
+     * rank. The prefixes rise, so counting those bytes gives the byte we want.
+     */
+    size_t byte   = popcount((((rank * kOnes) | kHighs) - prefix) & kHighs);
+    size_t before = ((prefix << 8) >> (8 * byte)) & 0xFF;
+    return 8 * byte + kSelectInByte[rank - before][(word >> (8 * byte)) & 0xFF];
+#endif
+  }
+}
+
+WaveletMatrixRMQ::WaveletMatrixRMQ(const RMQEntry* elems, size_t numElems) : numElems(numElems) {
+  if (numElems > UINT32_MAX) throw length_error("Too many elements for 32-bit ranks.");
+
+  /* Compress the values down to their ranks. Sorting (value, index) pairs
+   * packed into single words finds the distinct values and every element's
+   * rank in one go. Flipping the sign bit makes the values sort as unsigned.
+   */
+  vector<uint64_t> keys(numElems);
+  for (size_t i = 0; i < numElems; i++) {
+    keys[i] = (uint64_t(uint32_t(elems[i].value()) ^ 0x80000000u) << 32) | i;
+  }
+  sort(keys.begin(), keys.end());
+
+  vector<uint32_t> codes(numElems), next(numElems);
+  for (uint64_t key: keys) {
+    int32_t value = int32_t(uint32_t(key >> 32) ^ 0x80000000u);
+    if (alphabet.empty() || alphabet.back() != value) alphabet.push_back(value);
+    codes[uint32_t(key)] = alphabet.size() - 1;
+  }
+  alphabet.shrink_to_fit();
+  keys = vector<uint64_t>();
+
+  /* Write out each level's bits, then stably move the zeros ahead of the ones
+   * to get the order for the level below.
+   */
+  size_t numBits = max<size_t>(1, bit_width(alphabet.size() - (alphabet.empty()? 0 : 1)));
+  size_t numWords = numElems / 64 + 1;
+  levels.resize(numBits);
+
+  for (size_t l = 0; l < numBits; l++) {
+    size_t shift = numBits - 1 - l;
+    Level& level = levels[l];
+    level.words.assign(numWords, 0);
+    level.ranks.assign(numWords, 0);
+
+    for (size_t i = 0; i < numElems; i++) {
+      level.words[i / 64] |= uint64_t((codes[i] >> shift) & 1) << (i % 64);
+    }
+
+    size_t ones = 0;
+    for (size_t w = 0; w < numWords; w++) {
+      level.ranks[w] = ones;
+      ones += popcount(level.words[w]);
+    }
+    level.zeros = numElems - ones;
+
+    /* Note the word holding each sampled bit, ignoring the zero padding at
+     * the end of the last word.
+     */
+    for (size_t w = 0; w < numWords; w++) {
+      size_t onesThrough  = w + 1 < numWords? level.ranks[w + 1] : ones;
+      size_t zerosThrough = min((w + 1) * 64 - onesThrough, level.zeros);
+      while (level.oneSamples.size()  * kSampleRate < onesThrough)  level.oneSamples.push_back(w);
+      while (level.zeroSamples.size() * kSampleRate < zerosThrough) level.zeroSamples.push_back(w);
+    }
+    level.oneSamples.shrink_to_fit();
+    level.zeroSamples.shrink_to_fit();
+
+    size_t zeroPos = 0, onePos = level.zeros;
+    for (size_t i = 0; i < numElems; i++) {
+      if ((codes[i] >> shift) & 1) next[onePos++]  = codes[i];
+      else                         next[zeroPos++] = codes[i];
+    }
+    swap(codes, next);
+  }
+}
+
+size_t WaveletMatrixRMQ::Level::rank1(size_t index) const {
+  uint64_t below = words[index / 64] & ((uint64_t(1) << (index % 64)) - 1);
+  return ranks[index / 64] + popcount(below);
+}
+
+/* The samples on either side of the rank bound which word holds the bit, and
+ * the search for the last word with at most rank bits before it only looks
+ * between them.
+ */
+size_t WaveletMatrixRMQ::Level::select1(size_t rank) const {
+  size_t sample = rank / kSampleRate;
+  size_t low  = oneSamples[sample];
+  size_t high = sample + 1 < oneSamples.size()? oneSamples[sample + 1] + 1 : ranks.size();
+  while (high - low > 1) {
+    size_t mid = (low + high) / 2;
+    if (ranks[mid] <= rank) low = mid;
+    else high = mid;
+  }
+  return low * 64 + selectInWord(words[low], rank - ranks[low]);
+}
+
+size_t WaveletMatrixRMQ::Level::select0(size_t rank) const {
+  size_t sample = rank / kSampleRate;
+  size_t low  = zeroSamples[sample];
+  size_t high = sample + 1 < zeroSamples.size()? zeroSamples[sample + 1] + 1 : ranks.size();
+  while (high - low > 1) {
+    size_t mid = (low + high) / 2;
+    if (mid * 64 - ranks[mid] <= rank) low = mid;
+    else high = mid;
+  }
+  return low * 64 + selectInWord(~words[low], rank - (low * 64 - ranks[low]));
+}
+
+RMQEntry WaveletMatrixRMQ::kth(size_t low, size_t high, size_t k) const {
+  size_t code = 0;
+  for (const Level& level: levels) {
+    size_t onesLow  = level.rank1(low);
+    size_t onesHigh = level.rank1(high);
+    size_t zeros    = (high - low) - (onesHigh - onesLow);
+
+    code <<= 1;
+    if (k < zeros) {
+      low  -= onesLow;
+      high -= onesHigh;
+    } else {
+      k    -= zeros;
+      low   = level.zeros + onesLow;
+      high  = level.zeros + onesHigh;
+      code |= 1;
+    }
+  }
+  return RMQEntry(alphabet[code]);
+}
+
+size_t WaveletMatrixRMQ::countBelow(size_t low, size_t high, RMQEntry value) const {
+  size_t code = lower_bound(alphabet.begin(), alphabet.end(), value.value()) - alphabet.begin();
+  if (code >= alphabet.size()) return high - low;
+
+  size_t result = 0;
+  for (size_t l = 0; l < levels.size(); l++) {
+    const Level& level = levels[l];
+    size_t onesLow  = level.rank1(low);
+    size_t onesHigh = level.rank1(high);
+
+    if ((code >> (levels.size() - 1 - l)) & 1) {
+      result += (high - low) - (onesHigh - onesLow);
+      low  = level.zeros + onesLow;
+      high = level.zeros + onesHigh;
+    } else {
+      low  -= onesLow;
+      high -= onesHigh;
+    }
+  }
+  return result;
+}
+
+size_t WaveletMatrixRMQ::rmq(size_t low, size_t high) const {
+  /* Walk down toward the minimum, remembering which way we went. Since every
+   * level keeps equal elements in their original order, the leftmost copy of
+   * the minimum ends up at the start of the range on the bottom level.
+   */
+  uint64_t path = 0;
+  for (const Level& level: levels) {
+    size_t onesLow  = level.rank1(low);
+    size_t onesHigh = level.rank1(high);
+    size_t zeros    = (high - low) - (onesHigh - onesLow);
+
+    path <<= 1;
+    if (zeros > 0) {
+      low  -= onesLow;
+      high -= onesHigh;
+    } else {
+      low   = level.zeros + onesLow;
+      high  = level.zeros + onesHigh;
+      path |= 1;
+    }
+  }
+
+  /* Walk back up to where that element came from. */
+  size_t position = low;
+  for (size_t l = levels.size(); l-- > 0; path >>= 1) {
+    const Level& level = levels[l];
+    position = (path & 1)? level.select1(position - level.zeros) : level.select0(position);
+  }
+  return position;
+}
+
+size_t WaveletMatrixRMQ::memoryUsage() const {
+  size_t result = sizeof(*this) + alphabet.capacity() * sizeof(int32_t)
+                + levels.capacity() * sizeof(Level);
+  for (const Level& level: levels) {
+    result += level.words.capacity() * sizeof(uint64_t) + level.ranks.capacity() * sizeof(uint32_t)
+            + (level.oneSamples.capacity() + level.zeroSamples.capacity()) * sizeof(uint32_t);
+  }
+  return result;
+}
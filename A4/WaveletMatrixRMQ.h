@@ -0,0 +1,105 @@
+/******************************************************************************
+ * File: WaveletMatrixRMQ.h
+ *
+ * A range minimum query data structure implemented using a wavelet matrix,
+ * which also answers range k-th smallest and range counting queries.
+ *
+ * The values are first replaced by their ranks among the distinct values, so
+ * each one becomes a code of b = log sigma bits, where sigma is the number of
+ * distinct values. The matrix has one level per bit, starting with the most
+ * significant. Level i holds bit i of every code, with the elements ordered by
+ * a stable sort on their previous bits: after each level, the elements with a
+ * 0 bit move (in order) ahead of the elements with a 1 bit.
+ *
+ * A range of the array maps to a range at each level, and a rank query on the
+ * level's bits says how many of its elements go left and how many go right.
+ * Walking down the levels this way finds the k-th smallest value of a range,
+ * or counts the values below some bound, in O(log sigma) time. Each level is a
+ * packed bit vector with a running count of 1 bits before each word, so a rank
+ * is one lookup and one popcount.
+ *
+ * An RMQ finds the smallest value the same way and then walks back up the
+ * levels to find where its leftmost copy started out. Each step up is a select
+ * query. Every level also records which word holds every 256th 1 bit and every
+ * 256th 0 bit, so a select only searches the few words between two samples
+ * and then finds the bit within its word with broadword arithmetic (or one
+ * pdep instruction, where BMI2 is available). That makes RMQs take
+ * O(log sigma) expected time.
+ *
+ * Arrays must have fewer than 2^32 elements.
+ */
+
+#ifndef WaveletMatrixRMQ_Included
+#define WaveletMatrixRMQ_Included
+
+#include "RMQEntry.h"
+#include <vector>
+#include <cstdint>
+
+class WaveletMatrixRMQ {
+public:
+  /* Constructs an RMQ structure from the specified array of elements. That
+   * array may be empty.
+   *
+   * Unlike the other RMQ types, this one keeps its own copy of the values, in
+   * compressed form, so the elements array isn't used after construction.
+   */
+  WaveletMatrixRMQ(const RMQEntry* elems, std::size_t numElems);
+
+  /* Performs an RMQ over the specified range. You can assume that low < high
+   * and that the bounds are in range and don't need to do any error-handling
+   * if this is not the case.
+   *
+   * The interval here is half-open. That is, the range in question here is
+   * [low, high).
+   *
+   * This function returns the *index* of the leftmost minimum value.
+   */
+  std::size_t rmq(std::size_t low, std::size_t high) const;
+
+  /* Returns the k-th smallest value in [low, high), counting from zero, so
+   * k = 0 is the minimum and k = (high - low) / 2 is a median. Requires that
+   * k < high - low.
+   */
+  RMQEntry kth(std::size_t low, std::size_t high, std::size_t k) const;
+
+  /* Returns how many values in [low, high) are strictly less than the given
+   * value.
+   */
+  std::size_t countBelow(std::size_t low, std::size_t high, RMQEntry value) const;
+
+  /* Returns the number of bytes of memory used by this RMQ structure. */
+  std::size_t memoryUsage() const;
+
+private:
+  /* Select samples are taken at every kSampleRate-th bit of each kind. */
+  static constexpr std::size_t kSampleRate = 256;
+
+  /* One level of the matrix: a packed bit vector plus its rank and select
+   * directories.
+   */
+  struct Level {
+    std::vector<std::uint64_t> words;
+    std::vector<std::uint32_t> ranks;       // Number of 1 bits before each word
+    std::vector<std::uint32_t> oneSamples;  // Word holding each sampled 1 bit
+    std::vector<std::uint32_t> zeroSamples; // Word holding each sampled 0 bit
+    std::size_t zeros;                      // Number of 0 bits in the level
+
+    /* Number of 1 bits in positions [0, index). */
+    std::size_t rank1(std::size_t index) const;
+
+    /* Position of the 1 bit (or 0 bit) with the given rank. */
+    std::size_t select1(std::size_t rank) const;
+    std::size_t select0(std::size_t rank) const;
+  };
+
+  std::vector<std::int32_t> alphabet;  // Distinct values, in sorted order
+  std::vector<Level> levels;           // Most significant bit first
+  std::size_t numElems;
+
+  /* Copying is disabled. */
+  WaveletMatrixRMQ(const WaveletMatrixRMQ &) = delete;
+  void operator= (WaveletMatrixRMQ) = delete;
+};
+
+#endif